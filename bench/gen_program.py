@@ -0,0 +1,80 @@
+"""Generate a large, semantically valid program for the benchmarks.
+
+Usage: gen_program.py [--functions] STATEMENTS [OUTPUT]
+
+The output mixes declarations, arithmetic, conditionals, loops, comments and
+string literals in roughly the proportions seen in generated scripts. With
+--functions the statements are split over function bodies of
+FUNCTION_STATEMENTS statements each, every one called once at the top level.
+"""
+import sys
+
+FUNCTION_STATEMENTS = 50
+
+
+def write_statements(first, count, out):
+    declared = 0
+    for i in range(first, first + count):
+        kind = i % 8
+        if kind == 0 or declared < 2:
+            out.write("let v%d = %d + v%d * 3;\n" % (declared, i, max(declared - 1, 0))
+                      if declared else "let v0 = %d;\n" % i)
+            declared += 1
+        elif kind == 1:
+            out.write("v%d = v%d - %d / 2;\n" % (i % declared, (i * 7) % declared, i))
+        elif kind == 2:
+            out.write("if (v%d < %d && v%d != 0) {\n    v%d = v%d + 1;\n} else {\n    publish(\"big\");\n}\n"
+                      % (i % declared, i, (i + 1) % declared, i % declared, i % declared))
+        elif kind == 3:
+            out.write("/* block comment for statement %d */\n" % i)
+            out.write("publish(v%d);\n" % (i % declared))
+        elif kind == 4:
+            out.write("for (let k%d = 0; k%d < 10; k%d = k%d + 1) {\n    v%d = v%d + k%d;\n}\n"
+                      % (i, i, i, i, i % declared, i % declared, i))
+        elif kind == 5:
+            out.write("v%d = (v%d + v%d) * (v%d - 4); // trailing comment\n"
+                      % (i % declared, i % declared, (i + 3) % declared, (i + 5) % declared))
+        elif kind == 6:
+            out.write("publish(\"line %d done\");\n" % i)
+        else:
+            out.write("take v%d;\n" % (i % declared))
+
+
+class Indented:
+    def __init__(self, out):
+        self.out = out
+
+    def write(self, text):
+        self.out.write("".join("    " + line if line else line
+                               for line in text.splitlines(True)))
+
+
+def generate(statements, out, functions=False):
+    out.write("// generated benchmark input\n")
+    if not functions:
+        write_statements(0, statements, out)
+        return
+    for n, first in enumerate(range(0, statements, FUNCTION_STATEMENTS)):
+        out.write("function f%d(a, b) {\n" % n)
+        write_statements(first, min(FUNCTION_STATEMENTS, statements - first), Indented(out))
+        out.write("}\nf%d(%d, 2);\n" % (n, n))
+
+
+def main():
+    args = sys.argv[1:]
+    functions = "--functions" in args
+    args = [arg for arg in args if arg != "--functions"]
+    if not args:
+        sys.stderr.write(__doc__)
+        return 2
+    statements = int(args[0])
+    if len(args) > 1:
+        with open(args[1], "w") as out:
+            generate(statements, out, functions)
+    else:
+        generate(statements, sys.stdout, functions)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
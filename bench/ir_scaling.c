@@ -0,0 +1,83 @@
+// IR generation time against program size. Each input is parsed and checked
+// once, then lowered to IR several times; with instructions appended to a
+// growable array the cost per instruction stays flat however long the
+// program is.
+// Usage: ir_scaling FILE... (smallest first)
+#include "context.h"
+#include "ir.h"
+#include "parser.tab.h"
+#include "semantic.h"
+#include "source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Largest acceptable growth of the per-instruction cost across the inputs.
+// Timing noise stays well inside this; a walk to the tail per append blows
+// past it.
+#define MAX_COST_GROWTH 3.0
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s FILE...\n", argv[0]);
+        return 2;
+    }
+    const int rounds = 3;
+    double first_cost = 0, last_cost = 0;
+
+    printf("%14s %10s %16s\n", "instructions", "IR ms", "ns/instruction");
+    for (int i = 1; i < argc; i++) {
+        SourceBuffer src;
+        if (!source_map_file(&src, argv[i])) {
+            perror(argv[i]);
+            return 1;
+        }
+        CompilerContext ctx;
+        compiler_context_init(&ctx);
+        scan_source_buffer(&ctx, src.data, src.size + 2);
+        if (yyparse(&ctx) != 0 || ctx.has_syntax_error) {
+            fprintf(stderr, "%s: parse failed\n", argv[i]);
+            return 1;
+        }
+        ctx.root = ast_relayout_preorder(&ctx.ast, ctx.root);
+        if (!check_semantics(&ctx, ctx.root)) {
+            fprintf(stderr, "%s: %s\n", argv[i], ctx.diagnostics.items[0].message);
+            return 1;
+        }
+
+        double best = 1e30;
+        size_t instructions = 0;
+        for (int r = 0; r < rounds; r++) {
+            IRProgram ir = {0};
+            double start = now_seconds();
+            generate_ir(&ctx, ctx.root, &ir);
+            double elapsed = now_seconds() - start;
+            if (elapsed < best) best = elapsed;
+            instructions = ir.count;
+            ir_program_free(&ir);
+        }
+        if (!instructions) {
+            fprintf(stderr, "%s: no IR generated\n", argv[i]);
+            return 1;
+        }
+
+        double cost = best * 1e9 / (double)instructions;
+        if (i == 1) first_cost = cost;
+        last_cost = cost;
+        printf("%14zu %10.1f %16.1f\n", instructions, best * 1e3, cost);
+
+        compiler_context_free(&ctx);
+        source_release(&src);
+    }
+
+    double growth = last_cost / first_cost;
+    printf("per-instruction cost grew x%.2f from the smallest to the largest input: %s\n",
+           growth, growth <= MAX_COST_GROWTH ? "linear" : "NOT linear");
+    return growth <= MAX_COST_GROWTH ? 0 : 1;
+}
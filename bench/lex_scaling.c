@@ -0,0 +1,83 @@
+// Chunked parallel lexing: throughput per thread count, checked against the
+// serial token stream. Usage: lex_scaling FILE [ROUNDS]
+#include "intern.h"
+#include "source.h"
+#include "tokens.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool same_stream(const TokenStream* a, const TokenStream* b) {
+    return a->count == b->count &&
+           memcmp(a->kind, b->kind, a->count * sizeof(*a->kind)) == 0 &&
+           memcmp(a->offset, b->offset, a->count * sizeof(*a->offset)) == 0 &&
+           memcmp(a->length, b->length, a->count * sizeof(*a->length)) == 0 &&
+           memcmp(a->line, b->line, a->count * sizeof(*a->line)) == 0 &&
+           memcmp(a->value, b->value, a->count * sizeof(*a->value)) == 0;
+}
+
+// Best time over the rounds; the interner is reset first so every run hands
+// out ids from scratch, as a fresh compilation would.
+static double time_lex(Interner* names, SourceBuffer* src, int threads, int rounds,
+                       TokenStream* result) {
+    double best = 1e30;
+    for (int r = 0; r < rounds; r++) {
+        token_stream_free(result);
+        intern_reset(names);
+        double start = now_seconds();
+        if (threads == 0) {
+            lex_token_stream(names, result, src->data, src->size);
+        } else {
+            lex_token_stream_parallel(names, result, src->data, src->size, threads);
+        }
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s FILE [ROUNDS]\n", argv[0]);
+        return 2;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : 3;
+    SourceBuffer src;
+    if (!source_map_file(&src, argv[1])) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    Interner names = {0};
+    TokenStream serial, parallel;
+    token_stream_init(&serial);
+    token_stream_init(&parallel);
+    double base = time_lex(&names, &src, 0, rounds, &serial);
+    double mb = src.size / (1024.0 * 1024.0);
+    printf("input: %.1f MB, %zu tokens, best of %d rounds\n", mb, serial.count, rounds);
+    printf("  serial     : %8.1f MB/s\n", mb / base);
+
+    static const int thread_counts[] = {1, 2, 4, 8};
+    bool all_same = true;
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        double best = time_lex(&names, &src, thread_counts[i], rounds, &parallel);
+        bool same = same_stream(&serial, &parallel);
+        all_same = all_same && same;
+        printf("  %d thread%s  : %8.1f MB/s  x%.2f%s\n", thread_counts[i],
+               thread_counts[i] == 1 ? " " : "s", mb / best, base / best,
+               same ? "" : "  MISMATCH");
+    }
+
+    token_stream_free(&serial);
+    token_stream_free(&parallel);
+    intern_reset(&names);
+    source_release(&src);
+    return all_same ? 0 : 1;
+}
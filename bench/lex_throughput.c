@@ -0,0 +1,71 @@
+// Lexer throughput: scanning a mapped source in place versus flex's buffered
+// FILE* reader. Usage: lex_throughput FILE [ROUNDS]
+#include "context.h"
+#include "scanner.h"
+#include "source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long drain_scanner(CompilerContext* ctx) {
+    long tokens = 0;
+    YYSTYPE value;
+    while (yylex(&value, ctx->scanner) != 0) {
+        tokens++;
+    }
+    reset_lexer(ctx);
+    return tokens;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s FILE [ROUNDS]\n", argv[0]);
+        return 2;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    double best_file = 1e30, best_map = 1e30;
+    long tokens = 0;
+    size_t bytes = 0;
+    CompilerContext ctx;
+    compiler_context_init(&ctx);
+
+    for (int r = 0; r < rounds; r++) {
+        double start = now_seconds();
+        FILE* in = fopen(argv[1], "r");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+        scan_source_file(&ctx, in);
+        tokens = drain_scanner(&ctx);
+        fclose(in);
+        double elapsed = now_seconds() - start;
+        if (elapsed < best_file) best_file = elapsed;
+
+        start = now_seconds();
+        SourceBuffer src;
+        if (!source_map_file(&src, argv[1])) {
+            perror(argv[1]);
+            return 1;
+        }
+        scan_source_buffer(&ctx, src.data, src.size + 2);
+        drain_scanner(&ctx);
+        bytes = src.size;
+        source_release(&src);
+        elapsed = now_seconds() - start;
+        if (elapsed < best_map) best_map = elapsed;
+    }
+
+    double mb = bytes / (1024.0 * 1024.0);
+    printf("input: %.1f MB, %ld tokens, best of %d rounds\n", mb, tokens, rounds);
+    printf("  FILE* reader : %8.1f MB/s\n", mb / best_file);
+    printf("  mmap in place: %8.1f MB/s\n", mb / best_map);
+    compiler_context_free(&ctx);
+    return 0;
+}
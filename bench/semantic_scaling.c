@@ -0,0 +1,84 @@
+// Semantic check time against program size. Each input is parsed once and
+// then checked against a fresh symbol table; with a hashed symbol table the
+// cost per statement stays flat however many variables are declared.
+// Usage: semantic_scaling FILE... (smallest first)
+#include "context.h"
+#include "parser.tab.h"
+#include "semantic.h"
+#include "source.h"
+#include "tokens.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Largest acceptable growth of the per-statement cost across the inputs.
+// Timing noise stays well inside this; a quadratic lookup blows past it.
+#define MAX_COST_GROWTH 3.0
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t count_statements(const AST* ast, NodeId list) {
+    size_t statements = 0;
+    for (; list; list = ast_node(ast, list)->stmt_list.next) statements++;
+    return statements;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s FILE...\n", argv[0]);
+        return 2;
+    }
+    const int rounds = 3;
+    double first_cost = 0, last_cost = 0;
+
+    printf("%12s %12s %10s %14s\n", "statements", "symbols", "check ms", "ns/statement");
+    for (int i = 1; i < argc; i++) {
+        SourceBuffer src;
+        if (!source_map_file(&src, argv[i])) {
+            perror(argv[i]);
+            return 1;
+        }
+        CompilerContext ctx;
+        compiler_context_init(&ctx);
+        scan_source_buffer(&ctx, src.data, src.size + 2);
+        if (yyparse(&ctx) != 0) {
+            fprintf(stderr, "%s: parse failed\n", argv[i]);
+            return 1;
+        }
+        NodeId root = ast_relayout_preorder(&ctx.ast, ctx.root);
+        size_t statements = count_statements(&ctx.ast, root);
+
+        double best = 1e30;
+        size_t symbols = 0;
+        for (int r = 0; r < rounds; r++) {
+            free_symbol_table(ctx.table);
+            ctx.table = create_symbol_table();
+            call_graph_release(&ctx.calls);
+            double start = now_seconds();
+            if (!check_semantics(&ctx, root)) {
+                fprintf(stderr, "%s: %s\n", argv[i], ctx.diagnostics.items[0].message);
+                return 1;
+            }
+            double elapsed = now_seconds() - start;
+            if (elapsed < best) best = elapsed;
+            symbols = ctx.table->count;
+        }
+
+        double cost = best * 1e9 / (double)statements;
+        if (i == 1) first_cost = cost;
+        last_cost = cost;
+        printf("%12zu %12zu %10.1f %14.1f\n", statements, symbols, best * 1e3, cost);
+
+        compiler_context_free(&ctx);
+        source_release(&src);
+    }
+
+    double growth = last_cost / first_cost;
+    printf("per-statement cost grew x%.2f from the smallest to the largest input: %s\n",
+           growth, growth <= MAX_COST_GROWTH ? "linear" : "NOT linear");
+    return growth <= MAX_COST_GROWTH ? 0 : 1;
+}
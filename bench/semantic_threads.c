@@ -0,0 +1,176 @@
+// Checking function bodies on a thread pool: check time per thread count,
+// with the symbol table and annotations checked against a serial run, and
+// every annotation checked against the declaration it links to.
+// Usage: semantic_threads FILE [ROUNDS]
+#include "context.h"
+#include "parser.tab.h"
+#include "semantic.h"
+#include "source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// What a check leaves behind: the declarations and every node's annotations
+typedef struct {
+    Symbol* symbols;
+    size_t symbol_count;
+    ASTNode* nodes;
+    size_t node_count;
+} CheckResult;
+
+static void save_result(const CompilerContext* ctx, CheckResult* result) {
+    const SymbolTable* table = ctx->table;
+    result->symbol_count = table->count;
+    result->symbols = realloc(result->symbols, (table->count + 1) * sizeof(Symbol));
+    memcpy(result->symbols, table->symbols, table->count * sizeof(Symbol));
+    result->node_count = ctx->ast.count;
+    result->nodes = realloc(result->nodes, ctx->ast.count * sizeof(ASTNode));
+    memcpy(result->nodes, ctx->ast.nodes, ctx->ast.count * sizeof(ASTNode));
+}
+
+static bool same_result(const CheckResult* a, const CheckResult* b) {
+    if (a->symbol_count != b->symbol_count || a->node_count != b->node_count) return false;
+    for (size_t i = 0; i < a->symbol_count; i++) {
+        const Symbol* x = &a->symbols[i];
+        const Symbol* y = &b->symbols[i];
+        if (x->name != y->name || x->type != y->type || x->line_number != y->line_number ||
+            x->scope != y->scope || x->function != y->function) {
+            return false;
+        }
+    }
+    return memcmp(a->nodes, b->nodes, a->node_count * sizeof(ASTNode)) == 0;
+}
+
+// The declaration ref links to, if it is one of `name` in the right namespace
+static const Symbol* linked(const CheckResult* result, uint32_t ref, const char* name,
+                            bool function) {
+    if (!ref || ref > result->symbol_count) return NULL;
+    const Symbol* sym = &result->symbols[ref - 1];
+    return sym->name == name && sym->function == function ? sym : NULL;
+}
+
+// Nodes whose annotations disagree with their declarations. The program
+// checked without errors, so every name must be linked.
+static size_t bad_annotations(const CheckResult* result) {
+    size_t bad = 0;
+    for (size_t id = 1; id < result->node_count; id++) {
+        const ASTNode* node = &result->nodes[id];
+        const Symbol* sym;
+        bool ok = true;
+        switch (node->type) {
+            case AST_VAR_DECL:
+                sym = linked(result, node->var_decl.symbol, node->var_decl.name, false);
+                ok = sym && sym->line_number == node->line_number &&
+                     sym->type == result->nodes[node->var_decl.value].value_type;
+                break;
+            case AST_ASSIGNMENT:
+                ok = linked(result, node->assignment.symbol, node->assignment.name, false);
+                break;
+            case AST_INPUT:
+                ok = linked(result, node->input.symbol, node->input.name, false);
+                break;
+            case AST_FUNCTION_CALL:
+                ok = linked(result, node->func_call.symbol, node->func_call.name, true);
+                break;
+            case AST_IDENTIFIER:
+                sym = linked(result, node->identifier.symbol, node->identifier.name, false);
+                ok = sym && sym->type == node->value_type;
+                break;
+            case AST_UNARY_OP:
+                ok = node->value_type == result->nodes[node->unary.operand].value_type;
+                break;
+            default:
+                ok = node->value_type == ast_fixed_type((ASTNodeType)node->type);
+                break;
+        }
+        if (!ok) bad++;
+    }
+    return bad;
+}
+
+// Identifiers linked to a different declaration than in the serial run
+static size_t moved_links(const CheckResult* serial, const CheckResult* parallel) {
+    size_t moved = 0;
+    for (size_t id = 1; id < serial->node_count && id < parallel->node_count; id++) {
+        const ASTNode* node = &serial->nodes[id];
+        if (node->type != AST_IDENTIFIER) continue;
+        if (node->identifier.symbol != parallel->nodes[id].identifier.symbol) moved++;
+    }
+    return moved;
+}
+
+// Best time over the rounds, each against a fresh symbol table
+static double time_check(CompilerContext* ctx, NodeId root, int threads, int rounds,
+                         CheckResult* result) {
+    double best = 1e30;
+    ctx->check_threads = threads;
+    for (int r = 0; r < rounds; r++) {
+        free_symbol_table(ctx->table);
+        ctx->table = create_symbol_table();
+        call_graph_release(&ctx->calls);
+        double start = now_seconds();
+        if (!check_semantics(ctx, root)) {
+            fprintf(stderr, "%s\n", ctx->diagnostics.items[0].message);
+            exit(1);
+        }
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    save_result(ctx, result);
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s FILE [ROUNDS]\n", argv[0]);
+        return 2;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : 3;
+    SourceBuffer src;
+    if (!source_map_file(&src, argv[1])) {
+        perror(argv[1]);
+        return 1;
+    }
+    CompilerContext ctx;
+    compiler_context_init(&ctx);
+    scan_source_buffer(&ctx, src.data, src.size + 2);
+    if (yyparse(&ctx) != 0) {
+        fprintf(stderr, "%s: parse failed\n", argv[1]);
+        return 1;
+    }
+    NodeId root = ast_relayout_preorder(&ctx.ast, ctx.root);
+
+    CheckResult serial = {0}, parallel = {0};
+    double base = time_check(&ctx, root, 1, rounds, &serial);
+    printf("input: %zu nodes, %zu symbols, best of %d rounds\n", ctx.ast.count,
+           serial.symbol_count, rounds);
+    size_t bad = bad_annotations(&serial);
+    printf("  1 thread   : %8.1f ms%s\n", base * 1e3, bad ? "  BAD ANNOTATIONS" : "");
+    bool all_same = bad == 0;
+
+    static const int thread_counts[] = {2, 4, 8};
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        double best = time_check(&ctx, root, thread_counts[i], rounds, &parallel);
+        size_t moved = moved_links(&serial, &parallel);
+        bool same = moved == 0 && bad_annotations(&parallel) == 0 && same_result(&serial, &parallel);
+        all_same = all_same && same;
+        printf("  %d threads  : %8.1f ms  x%.2f%s\n", thread_counts[i], best * 1e3,
+               base / best, same ? "" : "  MISMATCH");
+        if (moved) printf("    %zu identifiers linked differently\n", moved);
+    }
+
+    free(serial.symbols);
+    free(serial.nodes);
+    free(parallel.symbols);
+    free(parallel.nodes);
+    compiler_context_free(&ctx);
+    source_release(&src);
+    return all_same ? 0 : 1;
+}
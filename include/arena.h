@@ -0,0 +1,29 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump-pointer allocator. Objects are carved out of large blocks and are only
+// ever freed all together by arena_release(), which makes allocation a pointer
+// increment and teardown a handful of free() calls.
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock* blocks;  // current block first
+    size_t used;         // bytes handed out, alignment padding included
+    size_t reserved;     // bytes obtained from malloc
+} Arena;
+
+#define ARENA_INIT { NULL, 0, 0 }
+
+// Uninitialised memory aligned for any object type.
+void* arena_alloc(Arena* arena, size_t size);
+
+// NUL-terminated copy of text[0..len).
+char* arena_strndup(Arena* arena, const char* text, size_t len);
+
+// Free every block; the arena can be used again afterwards.
+void arena_release(Arena* arena);
+
+#endif // ARENA_H
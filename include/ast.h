@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef enum {
 AST_PROGRAM,
@@ -24,47 +25,156 @@ AST_EXPR_LIST,
 AST_ID_LIST
 } ASTNodeType;
 
+// Binary and unary operators
+typedef enum {
+AST_OP_ADD,
+AST_OP_SUB,
+AST_OP_MUL,
+AST_OP_DIV,
+AST_OP_EQ,
+AST_OP_NEQ,
+AST_OP_LT,
+AST_OP_LEQ,
+AST_OP_GT,
+AST_OP_GEQ,
+AST_OP_AND,
+AST_OP_OR,
+AST_OP_NOT,
+AST_OP_NEG
+} ASTOperator;
+
+// Types of variables and expressions
+typedef enum {
+    TYPE_INT,
+    TYPE_STRING,
+    TYPE_UNKNOWN
+} VarType;
+
+// Nodes live in one array per compilation unit and refer to each other by
+// index. Id 0 is never a node and stands for "no node".
+typedef uint32_t NodeId;
+#define AST_NONE ((NodeId)0)
+
+// The most children any node has (a for loop)
+#define AST_MAX_CHILDREN 4
+
+// Semantic analysis annotates the tree in place: value_type is the type of an
+// expression node, and `symbol` links a name to its declaration (index + 1
+// into the symbol table's declarations; 0 until resolved).
 typedef struct ASTNode {
-ASTNodeType type;
+uint8_t type;        // ASTNodeType
+uint8_t value_type;  // VarType; see ast_fixed_type()
 int line_number;  // Line number where this node was created
 union {
-struct { struct ASTNode* left; struct ASTNode* right; const char* op; } binary;
-struct { const char* op; struct ASTNode* operand; } unary;
-struct { const char* name; struct ASTNode* value; } var_decl;
-struct { const char* name; struct ASTNode* value; } assignment;
-struct { struct ASTNode* condition; struct ASTNode* then_branch; struct ASTNode* else_branch; } if_stmt;
-struct { struct ASTNode* init; struct ASTNode* cond; struct ASTNode* post; struct ASTNode* body; } for_loop;
-struct { const char* name; struct ASTNode* params; struct ASTNode* body; } func_decl;
-struct { const char* name; struct ASTNode* args; } func_call;
-struct { const char* name; } input;
-struct { struct ASTNode* value; } publish;
+struct { NodeId left; NodeId right; ASTOperator op; } binary;
+struct { ASTOperator op; NodeId operand; } unary;
+struct { const char* name; NodeId value; uint32_t symbol; } var_decl;
+struct { const char* name; NodeId value; uint32_t symbol; } assignment;
+struct { NodeId condition; NodeId then_branch; NodeId else_branch; } if_stmt;
+struct { NodeId init; NodeId cond; NodeId post; NodeId body; } for_loop;
+struct { const char* name; NodeId params; NodeId body; } func_decl;
+struct { const char* name; NodeId args; uint32_t symbol; } func_call;
+struct { const char* name; uint32_t symbol; } input;
+struct { NodeId value; } publish;
 struct { int value; } number;
-struct { char* value; } string;
-struct { char* name; } identifier;
-struct { struct ASTNode* stmt; struct ASTNode* next; } stmt_list;
-struct { struct ASTNode* expr; struct ASTNode* next; } expr_list;
-struct { char* id; struct ASTNode* next; } id_list;
+struct { const char* value; } string;
+struct { const char* name; uint32_t scope; uint32_t symbol; } identifier;
+struct { NodeId stmt; NodeId next; } stmt_list;
+struct { NodeId expr; NodeId next; } expr_list;
+struct { const char* id; NodeId next; } id_list;
 };
 } ASTNode;
 
-ASTNode* create_var_decl_node(const char* name, ASTNode* value, int line_number);
-ASTNode* create_assignment_node(const char* name, ASTNode* value, int line_number);
-ASTNode* create_if_node(ASTNode* cond, ASTNode* then_branch, ASTNode* else_branch, int line_number);
-ASTNode* create_for_node(ASTNode* init, ASTNode* cond, ASTNode* post, ASTNode* body, int line_number);
-ASTNode* create_func_decl_node(const char* name, ASTNode* params, ASTNode* body, int line_number);
-ASTNode* create_func_call_node(const char* name, ASTNode* args, int line_number);
-ASTNode* create_input_node(const char* name, int line_number);
-ASTNode* create_publish_node(ASTNode* value, int line_number);
-ASTNode* create_binary_node(const char* op, ASTNode* left, ASTNode* right, int line_number);
-ASTNode* create_unary_node(const char* op, ASTNode* operand, int line_number);
-ASTNode* create_number_node(int value, int line_number);
-ASTNode* create_string_node(const char* value, int line_number);
-ASTNode* create_identifier_node(const char* name, int line_number);
-ASTNode* create_stmt_list_node(ASTNode* stmt, ASTNode* next, int line_number);
-ASTNode* create_expr_list_node(ASTNode* expr, ASTNode* next, int line_number);
-ASTNode* create_identifier_list(const char* id, ASTNode* next, int line_number);
-
-void print_ast(ASTNode* node, int indent);
-void free_ast(ASTNode* node);
+// The nodes of one compilation unit; a zeroed AST is empty. Creating a node
+// may move the array, so pointers from ast_node() are only good until the
+// next create_*() call; keep NodeIds across those.
+//
+// Numbers, identifiers and binary operations are hash-consed: creating one
+// that already exists returns the existing node, which keeps the line of its
+// first use. The AST is therefore a DAG, and two such expressions are
+// structurally equal exactly when their NodeIds are equal. Identifiers are
+// only shared within one scope (see ast_open_scope()), so an identifier node
+// always names one declaration. Apart from the semantic annotations, shared
+// nodes must not be modified once created.
+typedef struct {
+    NodeId id;        // AST_NONE: empty slot
+    uint32_t hash;    // compared before the node is looked at
+} ASTSharedSlot;
+
+typedef struct {
+    ASTNode* nodes;   // nodes[0] is reserved: AST_NONE is never a node
+    size_t count;
+    size_t capacity;
+    ASTSharedSlot* shared;  // hash-consing index into nodes
+    size_t shared_slots;
+    size_t shared_count;
+    uint32_t scope;         // scope new identifiers belong to; 0 is the program
+    uint32_t scope_count;
+} AST;
+
+static inline ASTNode* ast_node(const AST* ast, NodeId id) {
+    return &ast->nodes[id];
+}
+
+// Names and string literals must come from intern(); nodes keep the pointer
+// rather than a copy.
+NodeId create_var_decl_node(AST* ast, const char* name, NodeId value, int line_number);
+NodeId create_assignment_node(AST* ast, const char* name, NodeId value, int line_number);
+NodeId create_if_node(AST* ast, NodeId cond, NodeId then_branch, NodeId else_branch, int line_number);
+NodeId create_for_node(AST* ast, NodeId init, NodeId cond, NodeId post, NodeId body, int line_number);
+NodeId create_func_decl_node(AST* ast, const char* name, NodeId params, NodeId body, int line_number);
+NodeId create_func_call_node(AST* ast, const char* name, NodeId args, int line_number);
+NodeId create_input_node(AST* ast, const char* name, int line_number);
+NodeId create_publish_node(AST* ast, NodeId value, int line_number);
+NodeId create_binary_node(AST* ast, ASTOperator op, NodeId left, NodeId right, int line_number);
+NodeId create_unary_node(AST* ast, ASTOperator op, NodeId operand, int line_number);
+NodeId create_number_node(AST* ast, int value, int line_number);
+NodeId create_string_node(AST* ast, const char* value, int line_number);
+NodeId create_identifier_node(AST* ast, const char* name, int line_number);
+NodeId create_stmt_list_node(AST* ast, NodeId stmt, NodeId next, int line_number);
+NodeId create_expr_list_node(AST* ast, NodeId expr, NodeId next, int line_number);
+NodeId create_identifier_list(AST* ast, const char* id, NodeId next, int line_number);
+
+// The parser opens a scope for each function before parsing its parameters
+// and body, and closes it afterwards, so that an identifier inside a function
+// is never shared with the same name outside it. ast_open_scope() returns the
+// scope to pass to ast_close_scope(). Scopes are not saved in binary AST files:
+// they only matter while nodes are being created.
+uint32_t ast_open_scope(AST* ast);
+void ast_close_scope(AST* ast, uint32_t outer);
+
+// The type of the expression kinds whose type does not depend on any name:
+// integers for numbers and binary operations (arithmetic, and comparisons and
+// logic, which yield 0 or 1), strings for string literals. Nodes of these
+// kinds get it when they are created; other kinds start as TYPE_UNKNOWN.
+VarType ast_fixed_type(ASTNodeType type);
+
+// Whether nodes of this kind are hash-consed. A shared node keeps the line of
+// its first use, so passes that report or record lines use the line of the
+// innermost node around it that is not shared instead.
+bool ast_is_shared(ASTNodeType type);
+
+// Source spelling of an operator, e.g. "<=".
+const char* ast_operator_symbol(ASTOperator op);
+
+// Store the addresses of node's child links in evaluation order (AST_NONE
+// links included) and return how many there are.
+int ast_children(ASTNode* node, NodeId* children[AST_MAX_CHILDREN]);
+
+// The parser creates nodes bottom-up, so a parent lands after its children.
+// Rewrite the tree reachable from root so that every node comes right before
+// its subtree (preorder; a shared node at its first use): walks over the tree
+// then move forward through the array. Nodes not reachable from root are
+// dropped. Returns the new root id.
+NodeId ast_relayout_preorder(AST* ast, NodeId root);
+
+void print_ast(FILE* out, const AST* ast, NodeId node, int indent);
+
+// Free every node created so far; all NodeIds become invalid.
+void ast_release(AST* ast);
+// Same for the nodes, but keep the storage for the nodes that follow.
+void ast_clear(AST* ast);
+size_t ast_node_count(const AST* ast);
+size_t ast_bytes_used(const AST* ast);
 
 #endif
\ No newline at end of file
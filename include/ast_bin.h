@@ -0,0 +1,34 @@
+#ifndef AST_BIN_H
+#define AST_BIN_H
+
+#include "ast.h"
+#include "intern.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Binary AST files (--emit=ast-bin, --from-ast): a saved parse that can be
+// loaded again without lexing or parsing the source. All fields are 32-bit
+// (or 16-bit) words in the writer's byte order, and every section starts on a
+// 4-byte boundary, so a mapped file is read in place:
+//
+//   header      magic "BAST", byte-order mark, version, counts, root
+//   nodes       node_count fixed-size records, index = NodeId (record 0 is
+//               the unused AST_NONE slot); names as string table indices
+//   lines       node_count line numbers
+//   offsets     string_count + 1 offsets into the string bytes
+//   strings     the names and string literals, back to back
+//
+// Files from another version or byte order are rejected rather than converted.
+#define AST_BIN_VERSION 1
+
+// Write the AST, shared nodes included, with root as its root.
+bool ast_write_binary(FILE* out, const AST* ast, NodeId root, const Interner* names);
+
+// Rebuild the AST stored in data[0..size) into an empty ast, interning its
+// names into `names`. data must be 4-byte aligned, as mapped files and
+// malloc()ed buffers are. Returns false, leaving ast empty, when the data is
+// not a well-formed AST file of this version and byte order.
+bool ast_read_binary(AST* ast, Interner* names, const void* data, size_t size, NodeId* root);
+
+#endif // AST_BIN_H
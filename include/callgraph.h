@@ -0,0 +1,35 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include "ast.h"
+#include <stddef.h>
+
+// Which functions call which, recorded by semantic analysis as it resolves
+// calls. Functions are their AST_FUNCTION_DECL nodes; calls made outside any
+// function body, i.e. by the program itself, have AST_NONE as their caller.
+// An edge is kept per call site.
+typedef struct {
+    NodeId caller;
+    NodeId callee;
+} CallEdge;
+
+typedef struct {
+    CallEdge* edges;
+    size_t count;
+    size_t capacity;
+} CallGraph;
+
+void call_graph_add(CallGraph* graph, NodeId caller, NodeId callee);
+// Add every edge of `from`.
+void call_graph_append(CallGraph* graph, const CallGraph* from);
+void call_graph_release(CallGraph* graph);
+
+// Unlink the declarations of the functions the program cannot reach through
+// any chain of calls from its own statements, so that later phases never see
+// them; nested declarations in any statement list included. ctx->calls must
+// describe the checked program at ctx->root. Returns how many declarations
+// were removed.
+typedef struct CompilerContext CompilerContext;
+size_t eliminate_dead_functions(CompilerContext* ctx);
+
+#endif // CALLGRAPH_H
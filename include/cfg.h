@@ -0,0 +1,63 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "ir.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The control-flow graph of one IR unit. A basic block is a run of
+// instructions entered only at its first and left only after its last: a new
+// block starts at every label and after every jump or return. Blocks are
+// numbered in code order, so block 0 is the entry, and each covers the
+// instructions [first, end) of the unit.
+//
+// Passes that remove instructions but leave labels, jumps and returns alone
+// keep the graph valid by compacting the code one block at a time and
+// storing each block's new range (see the optimizer); the edges, orders,
+// dominators and loops do not change.
+#define CFG_NONE UINT32_MAX
+
+typedef struct {
+    size_t first, end;
+    uint32_t succ[2];           // the jump target, if any, then the fall-through;
+    uint32_t succ_count;        // an edge is listed once
+    uint32_t pred_first;        // predecessors: preds[pred_first .. + pred_count)
+    uint32_t pred_count;
+    uint32_t rpo;               // position in the reverse postorder; CFG_NONE when unreachable
+    uint32_t idom;              // immediate dominator, the entry's being itself;
+                                // CFG_NONE when unreachable
+    uint32_t loop;              // innermost loop containing the block, or CFG_NONE
+} IRBlock;
+
+// A natural loop: its header and every block that reaches one of the
+// header's back edges without going through the header. Loops with
+// different headers are either nested or disjoint.
+typedef struct {
+    uint32_t header;
+    uint32_t parent;            // the innermost loop around this one, or CFG_NONE
+    uint32_t depth;             // 1 for an outermost loop
+    uint32_t block_first;       // blocks: loop_blocks[block_first .. + block_count)
+    uint32_t block_count;
+} CFGLoop;
+
+typedef struct {
+    IRBlock* blocks;
+    size_t block_count;
+    uint32_t* preds;
+    uint32_t* rpo;              // the reachable blocks in reverse postorder
+    size_t rpo_count;
+    CFGLoop* loops;             // inner loops before the loops around them
+    size_t loop_count;
+    uint32_t* loop_blocks;
+} CFG;
+
+// Build the graph of the program's own code (not its function units).
+void cfg_build(CFG* cfg, const IRProgram* program);
+void cfg_free(CFG* cfg);
+
+// Whether every path from the entry to b goes through a. Unreachable blocks
+// dominate nothing and are dominated by nothing.
+bool cfg_dominates(const CFG* cfg, uint32_t a, uint32_t b);
+
+#endif // CFG_H
@@ -3,7 +3,12 @@
 
 #include "ir.h" // Depends on the IR structures
 
-// Function to generate final code from IR
-void generate_code(IRInstruction* head);
+// Function to generate final code from IR: the program's code, a HALT, and
+// then its functions
+void generate_code(FILE* out, const IRProgram* program);
+// Code for one top-level statement of a streamed program, with the functions
+// it declares placed in line; generate_code_end() ends the stream.
+void generate_code_statement(FILE* out, const IRProgram* program);
+void generate_code_end(FILE* out);
 
 #endif // CODEGEN_H 
\ No newline at end of file
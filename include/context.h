@@ -0,0 +1,53 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "ast.h"
+#include "diagnostics.h"
+#include "intern.h"
+#include "ir.h"
+#include "scanner.h"
+#include "semantic.h"
+#include "token_display.h"
+#include "tokens.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Everything one compilation reads or writes, from the scanner to the IR
+// generator. Contexts share no state, so separate threads can each compile a
+// source through their own context at the same time.
+struct CompilerContext {
+    Interner names;             // identifiers, string literals, temps, labels
+    AST ast;
+    NodeId root;                // the program, set by the parser
+    DiagnosticList diagnostics; // syntax and semantic errors, in the order found
+
+    // Lexing and parsing
+    yyscan_t scanner;
+    ScanState scan;             // the scanner's yyextra
+    TokenDisplay token_display; // traced by the scanner when scan.display is set
+    const TokenStream* replay;  // token source when set, see token_stream_replay()
+    size_t replay_pos;
+    int line_num;               // line of the last token handed to the parser
+    bool has_syntax_error;
+
+    // Streaming: when set, the parser hands every complete top-level statement
+    // to this callback instead of collecting the program under root, and frees
+    // its nodes afterwards. Returning false stops the parse.
+    bool (*on_statement)(CompilerContext* ctx, NodeId statement, void* arg);
+    void* on_statement_arg;
+
+    // Semantic analysis
+    SymbolTable* table;
+    CallGraph calls;            // for eliminate_dead_functions()
+    int check_threads;          // for function bodies of large programs; 0: one per CPU
+
+    // IR generation
+    IRGenState ir;
+};
+
+void compiler_context_init(CompilerContext* ctx);
+
+// Free everything the context owns. Names and nodes from it become invalid.
+void compiler_context_free(CompilerContext* ctx);
+
+#endif // CONTEXT_H
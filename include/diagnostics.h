@@ -0,0 +1,46 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include "arena.h"
+#include <stddef.h>
+#include <stdio.h>
+
+// The errors of one compilation, kept so that one run can report all of them.
+// The list is bounded: once `limit` diagnostics are held, further ones are
+// only counted, so a badly broken input cannot flood the output. Records and
+// messages live in an arena and are freed together.
+typedef struct {
+    int line_number;
+    const char* message;    // complete text, e.g. "Syntax Error at line 3: ..."
+} Diagnostic;
+
+typedef struct {
+    Arena arena;
+    Diagnostic* items;      // room for `limit`, allocated on first use
+    size_t count;
+    size_t limit;
+    size_t dropped;         // reported past the limit
+} DiagnosticList;
+
+#define DIAGNOSTIC_LIMIT 100
+
+// A limit of 0 stands for DIAGNOSTIC_LIMIT; a zeroed list is ready to use.
+void diagnostics_init(DiagnosticList* list, size_t limit);
+void diagnostics_release(DiagnosticList* list);
+
+// Add a copy of message.
+void diagnostic_add(DiagnosticList* list, int line_number, const char* message);
+
+// Add every diagnostic of `from`, counting what it dropped.
+void diagnostics_append(DiagnosticList* list, const DiagnosticList* from);
+
+// Stably order diagnostics [first, count) by line.
+void diagnostics_sort(DiagnosticList* list, size_t first);
+
+// Print diagnostics [*printed, count), one per line, and advance *printed.
+void diagnostics_print(FILE* out, const DiagnosticList* list, size_t* printed);
+
+// Diagnostics held plus dropped.
+size_t diagnostics_total(const DiagnosticList* list);
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,46 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include "arena.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// String interning. Every identifier (and string literal) is interned once by
+// the lexer; all later phases hold the canonical pointer, so two names are
+// equal exactly when their pointers are equal and nobody owns or frees name
+// text. Each compilation has its own Interner (see context.h).
+
+typedef uint32_t InternId;
+
+// A zeroed Interner is empty and ready to use.
+typedef struct {
+    uint32_t* slots;        // open addressing; 0 is empty, otherwise id + 1
+    uint32_t* slot_hashes;
+    size_t slot_count;
+    const char** names;     // indexed by id
+    size_t name_count;
+    size_t name_capacity;
+    Arena strings;
+} Interner;
+
+// Canonical copy of text. Equal strings always return the same pointer.
+const char* intern(Interner* names, const char* text);
+const char* intern_n(Interner* names, const char* text, size_t len);
+
+// intern_n() with the hash already computed by intern_hash(), which is safe to
+// call from any thread.
+uint32_t intern_hash(const char* text, size_t len);
+const char* intern_hashed(Interner* names, const char* text, size_t len, uint32_t hash);
+
+// Dense id (0, 1, 2, ...) of a pointer returned by intern(), and back.
+InternId intern_id(const char* canonical);
+const char* intern_name(const Interner* names, InternId id);
+size_t intern_count(const Interner* names);
+
+// Bytes of string storage in use, headers included.
+size_t intern_bytes_used(const Interner* names);
+
+// Drop every interned string. Previously returned pointers become invalid.
+void intern_reset(Interner* names);
+
+#endif // INTERN_H
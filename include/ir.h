@@ -2,6 +2,10 @@
 #define IR_H
 
 #include "ast.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 
 // Operations in our Intermediate Representation (Three-Address Code)
 typedef enum {
@@ -12,41 +16,176 @@ typedef enum {
     IR_DIV,
     IR_LABEL,       // L1:
     IR_GOTO,        // goto L1
-    IR_IF_GOTO,     // if t1 goto L1
-    IR_PARAM,
-    IR_CALL,
-    IR_RETURN
+    IR_IF_EQ,       // if a == b goto L1
+    IR_IF_NE,       // if a != b goto L1
+    IR_IF_LT,       // if a < b goto L1
+    IR_IF_LE,       // if a <= b goto L1
+    IR_IF_GT,       // if a > b goto L1
+    IR_IF_GE,       // if a >= b goto L1
+    IR_PARAM,       // param x: the next argument of the coming call
+    IR_CALL,        // t1 = call f, n: call f with the last n params
+    IR_RETURN       // return, or return x
 } IROp;
 
-// An operand in an IR instruction
+// Jumps keep their target label in result; every other op with a result
+// assigns it
+static inline bool ir_is_jump(IROp op) {
+    return op == IR_GOTO || (op >= IR_IF_EQ && op <= IR_IF_GE);
+}
+
+// An operand, packed into 32 bits: its kind in the top bits and a number
+// below. Temps, labels and variables are numbered densely (variables per
+// program, in order of first use); a constant is an index into the program's
+// constant pool, and a function an index into its callees. Two operands are
+// the same exactly when their words are equal, and the empty operand is 0.
+typedef uint32_t IROperand;
+
+typedef enum {
+    OP_EMPTY,
+    OP_CONSTANT,
+    OP_VARIABLE,
+    OP_TEMP,
+    OP_LABEL,
+    OP_FUNCTION
+} IROperandKind;
+
+#define IR_OPERAND_SHIFT 29
+#define IR_OPERAND_INDEX_MASK ((1u << IR_OPERAND_SHIFT) - 1)
+#define IR_NO_OPERAND ((IROperand)0)
+
+static inline IROperand ir_operand(IROperandKind kind, uint32_t index) {
+    return ((uint32_t)kind << IR_OPERAND_SHIFT) | (index & IR_OPERAND_INDEX_MASK);
+}
+
+static inline IROperandKind ir_operand_kind(IROperand op) {
+    return (IROperandKind)(op >> IR_OPERAND_SHIFT);
+}
+
+static inline uint32_t ir_operand_index(IROperand op) {
+    return op & IR_OPERAND_INDEX_MASK;
+}
+
+// Lines past IR_MAX_LINE are all recorded as IR_MAX_LINE.
+#define IR_MAX_LINE ((1u << 24) - 1)
+
+// A single instruction in the IR: 16 bytes, so that passes stream through
+// the array without chasing pointers.
 typedef struct {
-    enum {
-        OP_EMPTY,
-        OP_CONSTANT,
-        OP_VARIABLE,
-        OP_TEMP,
-        OP_LABEL
-    } type;
-    union {
-        int constant;
-        char* name; // For variables, temps, and labels
-    };
-} IROperand;
-
-// A single instruction in the IR
-typedef struct IRInstruction {
-    IROp op;
-    int line_number; // Line in source code
+    uint32_t op : 8;            // IROp
+    uint32_t line_number : 24;  // Line in source code
     IROperand result;
     IROperand arg1;
     IROperand arg2;
-    struct IRInstruction* next;
 } IRInstruction;
 
-// Function prototypes
-IRInstruction* generate_ir(ASTNode* node);
-void print_ir(IRInstruction* head);
-void print_ir_instruction(IRInstruction* instruction);
-void free_ir(IRInstruction* head);
+_Static_assert(sizeof(IRInstruction) == 16, "IR instructions are meant to stay 16 bytes");
+
+// A for-loop as lowered to IR. Its labels mark the four parts:
+//
+//   header:  if not cond goto exit
+//   body:    the loop body
+//   latch:   the post statement; goto header
+//   exit:
+//
+// When the loop counts with a variable -- the post statement adds or
+// subtracts a constant to the variable the condition compares -- that
+// variable, its start value (if set by the init statement), the bound it is
+// compared with and the step are recorded; otherwise induction is empty.
+// Labels survive every pass, so the record stays valid as code is removed.
+typedef struct {
+    IROperand header, body, latch, exit;
+    IROperand induction;
+    IROperand start;            // empty when the init sets another variable
+    IROperand bound;            // empty when not a number or variable
+    ASTOperator compare;        // the condition is `induction compare bound`
+    int step;
+    int line_number;
+} IRLoop;
+
+// A piece of IR: its instructions in order, in one growable array, so that
+// appending is amortised O(1) and passes walk memory front to back, together
+// with the pools its operands refer to. A zeroed program is empty and ready
+// to use.
+//
+// Every function is a unit of its own, with its own operands: its parameters
+// are variables 0 .. param_count - 1, in order, and the rest of its variables
+// are locals. The units hang off the program they were compiled with, nested
+// functions included; a nested function is named after the function that
+// declares it, as in `outer.inner`. A call passes its arguments with one
+// param per argument, in order, and the value of the call is what the callee
+// returns.
+typedef struct IRProgram {
+    IRInstruction* code;
+    size_t count;
+    size_t capacity;
+    int* constants;             // OP_CONSTANT index -> value
+    size_t constant_count;
+    size_t constant_capacity;
+    uint32_t* constant_slots;   // open addressing on the value; 0 is empty,
+    size_t constant_slot_count; // otherwise the constant's index + 1
+    const char** variables;     // OP_VARIABLE index -> interned name
+    size_t variable_count;
+    size_t variable_capacity;
+    uint32_t temp_count;        // temps are t0 .. t(temp_count - 1)
+    const char** callees;       // OP_FUNCTION index -> function name
+    size_t callee_count;
+    size_t callee_capacity;
+    const char* name;           // function units only; NULL for the program
+    uint32_t param_count;
+    struct IRProgram* functions;  // the program's function units
+    size_t function_count;
+    size_t function_capacity;
+    IRLoop* loops;              // outer loops before the loops they contain
+    size_t loop_count;
+    size_t loop_capacity;
+} IRProgram;
+
+// Memo of the binary expressions generated so far
+#define IR_EXPR_CACHE_SIZE 128
+
+typedef struct {
+    IROp op;
+    IROperand left;
+    IROperand right;
+    IROperand temp;
+} IRExprCacheEntry;
+
+// Numbering and memo table of an IR generation, kept in the CompilerContext
+typedef struct {
+    int temp_count;
+    int label_count;
+    IRExprCacheEntry expr_cache[IR_EXPR_CACHE_SIZE];
+    int expr_cache_count;
+} IRGenState;
+
+typedef struct CompilerContext CompilerContext;
+
+// Append an instruction with empty operands and return it. The pointer is
+// only valid until the next append.
+IRInstruction* ir_append(IRProgram* program, IROp op, int line_number);
+void ir_program_free(IRProgram* program);  // function units included
+// Whether the program, or any of its functions, has code
+bool ir_program_empty(const IRProgram* program);
+
+// The operand for a value, added to the constant pool if it is not there yet
+IROperand ir_add_constant(IRProgram* program, int value);
+// Add a name to the variables, or the callees, and return the operand for it.
+// Neither looks for an existing entry.
+IROperand ir_add_variable(IRProgram* program, const char* name);
+IROperand ir_add_callee(IRProgram* program, const char* name);
+
+static inline int ir_constant_value(const IRProgram* program, IROperand op) {
+    return program->constants[ir_operand_index(op)];
+}
+
+// Append the IR for the statements at node to program, and add the functions
+// declared there to its function units.
+void generate_ir(CompilerContext* ctx, NodeId node, IRProgram* program);
+// IR for one top-level statement of a streamed program. Temps are numbered
+// afresh for each statement; labels keep counting so they stay unique across
+// the whole output.
+void generate_ir_statement(CompilerContext* ctx, NodeId statement, IRProgram* program);
+void print_ir(FILE* out, const IRProgram* program);
+void print_operand(FILE* out, const IRProgram* program, IROperand op);
 
 #endif // IR_H 
\ No newline at end of file
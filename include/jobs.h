@@ -0,0 +1,15 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stddef.h>
+
+// Run job(arg, 0..jobs-1) on up to `threads` threads, the caller included,
+// and return once every job has finished. Jobs are handed out in index order
+// as threads come free; a thread that fails to start just leaves its share to
+// the others, so everything still runs with threads = 1.
+void run_jobs(int threads, size_t jobs, void (*job)(void* arg, size_t index), void* arg);
+
+// Number of online CPUs, at least 1.
+int online_cpus(void);
+
+#endif // JOBS_H
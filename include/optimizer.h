@@ -3,7 +3,11 @@
 
 #include "ir.h"
 
-// Main optimization function
-void optimize_ir(IRInstruction* head);
+// Main optimization function; rewrites the program and its function units in
+// place. A non-NULL trace stream receives the applied passes and the optimized
+// IR. With keep_variables, dead code elimination only removes the program's
+// temps: the program is one piece of a larger one whose later pieces may still
+// read its variables. A function's locals never outlive it.
+void optimize_ir(IRProgram* program, FILE* trace, bool keep_variables);
 
 #endif // OPTIMIZER_H 
\ No newline at end of file
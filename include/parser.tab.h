@@ -1,23 +1,22 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* A Bison parser, made by GNU Bison 2.4.1.  */
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-/* Skeleton interface for Bison's Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
-   
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -28,74 +27,113 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
 
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     UNKNOWN = 258,
-     IDENTIFIER = 259,
-     NUMBER = 260,
-     STRING = 261,
-     LET = 262,
-     FUNCTION = 263,
-     IF = 264,
-     ELSE = 265,
-     FOR = 266,
-     TAKE = 267,
-     PUBLISH = 268,
-     EQ = 269,
-     NEQ = 270,
-     LEQ = 271,
-     GEQ = 272,
-     AND = 273,
-     OR = 274,
-     ASSIGN = 275,
-     LT = 276,
-     GT = 277,
-     PLUS = 278,
-     MINUS = 279,
-     MUL = 280,
-     DIV = 281,
-     NOT = 282,
-     LPAREN = 283,
-     RPAREN = 284,
-     LBRACE = 285,
-     RBRACE = 286,
-     COMMA = 287,
-     SEMICOLON = 288
-   };
+#ifndef YY_YY_INCLUDE_PARSER_TAB_H_INCLUDED
+# define YY_YY_INCLUDE_PARSER_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
 #endif
+/* "%code requires" blocks.  */
+#line 15 "src/parser.y"
+
+#include "ast.h"
+typedef struct CompilerContext CompilerContext;
+typedef struct { NodeId head; NodeId tail; } StatementList;  // list being built
 
+#line 55 "include/parser.tab.h"
 
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    UNKNOWN = 258,                 /* UNKNOWN  */
+    IDENTIFIER = 259,              /* IDENTIFIER  */
+    NUMBER = 260,                  /* NUMBER  */
+    STRING = 261,                  /* STRING  */
+    LET = 262,                     /* LET  */
+    FUNCTION = 263,                /* FUNCTION  */
+    IF = 264,                      /* IF  */
+    ELSE = 265,                    /* ELSE  */
+    FOR = 266,                     /* FOR  */
+    TAKE = 267,                    /* TAKE  */
+    PUBLISH = 268,                 /* PUBLISH  */
+    EQ = 269,                      /* EQ  */
+    NEQ = 270,                     /* NEQ  */
+    LEQ = 271,                     /* LEQ  */
+    GEQ = 272,                     /* GEQ  */
+    AND = 273,                     /* AND  */
+    OR = 274,                      /* OR  */
+    ASSIGN = 275,                  /* ASSIGN  */
+    LT = 276,                      /* LT  */
+    GT = 277,                      /* GT  */
+    PLUS = 278,                    /* PLUS  */
+    MINUS = 279,                   /* MINUS  */
+    MUL = 280,                     /* MUL  */
+    DIV = 281,                     /* DIV  */
+    NOT = 282,                     /* NOT  */
+    LPAREN = 283,                  /* LPAREN  */
+    RPAREN = 284,                  /* RPAREN  */
+    LBRACE = 285,                  /* LBRACE  */
+    RBRACE = 286,                  /* RBRACE  */
+    COMMA = 287,                   /* COMMA  */
+    SEMICOLON = 288                /* SEMICOLON  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
 
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+union YYSTYPE
 {
-
-/* Line 1676 of yacc.c  */
-#line 18 "src/parser.y"
+#line 31 "src/parser.y"
 
     int int_val;
-    char* string_val;
-    struct ASTNode* ast;
-
+    const char* string_val;
+    NodeId ast;
+    StatementList list;
+    uint32_t scope;
 
+#line 113 "include/parser.tab.h"
 
-/* Line 1676 of yacc.c  */
-#line 93 "src/parser.tab.h"
-} YYSTYPE;
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
-extern YYSTYPE yylval;
 
 
+
+#ifndef YYPUSH_MORE_DEFINED
+# define YYPUSH_MORE_DEFINED
+enum { YYPUSH_MORE = 4 };
+#endif
+
+typedef struct yypstate yypstate;
+
+
+int yyparse (CompilerContext* ctx);
+int yypush_parse (yypstate *ps,
+                  int pushed_char, YYSTYPE const *pushed_val, CompilerContext* ctx);
+int yypull_parse (yypstate *ps, CompilerContext* ctx);
+yypstate *yypstate_new (void);
+void yypstate_delete (yypstate *ps);
+
+
+#endif /* !YY_YY_INCLUDE_PARSER_TAB_H_INCLUDED  */
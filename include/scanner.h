@@ -0,0 +1,61 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include "parser.tab.h"
+#include "intern.h"
+#include "token_display.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Entry points into the reentrant flex scanner (src/lexer.l)
+
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+
+// Per-scanner state, reached from the rules as yyextra.
+typedef struct {
+    int line;               // current line number, from 1
+    bool defer_values;      // leave IDENTIFIER/STRING values and unknown-character
+                            // reports to the caller; set by chunk workers, which
+                            // must not touch the interner or stdout
+    Interner* names;        // where IDENTIFIER and STRING values are interned
+    TokenDisplay* display;  // token trace; NULL for none
+} ScanState;
+
+// Start conditions a scan can begin or end in
+enum { SCAN_INITIAL, SCAN_COMMENT, SCAN_LINE_COMMENT };
+
+// Generated by flex
+int yylex_init_extra(ScanState* state, yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+int yylex(YYSTYPE* lval, yyscan_t scanner);
+ScanState* yyget_extra(yyscan_t scanner);
+char* yyget_text(yyscan_t scanner);
+int yyget_leng(yyscan_t scanner);
+
+// Scan an in-memory buffer in place. base[size - 2] and base[size - 1] must be
+// NUL; the scanner temporarily writes into the buffer while matching.
+bool scanner_scan_buffer(yyscan_t scanner, char* base, size_t size);
+
+int scanner_start_condition(yyscan_t scanner);
+void scanner_begin(yyscan_t scanner, int condition);
+
+// Point the context's scanner, which the parser reads from, at its input.
+typedef struct CompilerContext CompilerContext;
+bool scan_source_buffer(CompilerContext* ctx, char* base, size_t size);
+void scan_source_file(CompilerContext* ctx, FILE* in);
+// Like scan_source_file(), reading line by line instead of a block at a time,
+// for input that arrives while it is being compiled.
+void scan_source_stream(CompilerContext* ctx, FILE* in);
+void reset_lexer(CompilerContext* ctx);
+
+// Decode a quoted string literal of `length` bytes (quotes included) into dst
+// and return the decoded length. dst may be text itself.
+size_t unescape_string(char* dst, const char* text, size_t length);
+
+void report_unknown_character(int line, const char* text, int length);
+
+#endif // SCANNER_H
@@ -2,50 +2,71 @@
 #define SEMANTIC_H
 
 #include "ast.h"
+#include "callgraph.h"
+#include "diagnostics.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-// Define types for variables
-typedef enum {
-    TYPE_INT,
-    TYPE_STRING,
-    TYPE_UNKNOWN
-} VarType;
-
-typedef struct Symbol {
+// One declaration. Names are interned, so a name is found by pointer.
+typedef struct {
     const char* name;
-    VarType type;        // Add type information
+    VarType type;
     int line_number;     // Line number where symbol is defined
-    struct Symbol* next;
+    uint32_t shadowed;   // index + 1 of the same-named declaration it hides, or 0
+    uint32_t scope;      // depth of the scope it belongs to; 0 is the program
+    bool function;       // functions and variables are separate namespaces
+    NodeId decl;         // a function's AST_FUNCTION_DECL
 } Symbol;
 
+typedef struct {
+    const char* name;    // NULL: empty slot
+    uint32_t variable;   // index + 1 of the newest declaration, or 0
+    uint32_t function;
+} SymbolSlot;
+
+// Every declaration seen so far, with an open-addressing index from each name
+// to its newest visible declaration. push_scope() opens a function's scope
+// and pop_scope() takes its declarations out of the index again, restoring
+// whatever they hid; they stay in `symbols`, where the AST refers to them.
+// A scope only sees its own declarations: a function body sees its
+// parameters and locals, not the program's names.
 typedef struct SymbolTable {
-    Symbol* variables;
-    Symbol* functions;
+    Symbol* symbols;
+    size_t count;
+    size_t capacity;
+    SymbolSlot* slots;
+    size_t slot_count;
+    size_t slots_used;
+    size_t* scope_start; // symbols index at which each open scope begins
+    size_t depth;
+    size_t scope_capacity;
 } SymbolTable;
 
-// Error reporting structure
-typedef struct {
-    bool has_error;
-    int line_number;
-    char* message;
-} SemanticError;
-
-// Global error state
-extern SemanticError last_semantic_error;
+typedef struct CompilerContext CompilerContext;
 
 // Function declarations
 SymbolTable* create_symbol_table(void);
 void free_symbol_table(SymbolTable* table);
-bool check_semantics(ASTNode* node, SymbolTable* table);
-bool analyze_ast(ASTNode* root, SymbolTable* table);  // Alias for check_semantics
+void push_scope(SymbolTable* table);
+void pop_scope(SymbolTable* table);
+
+// Check the tree at root against ctx->table, annotating it on the way: every
+// expression gets its value_type and every name its symbol. Checking goes on
+// past errors; each one is added to ctx->diagnostics, in line order, and the
+// result is false if there was any. Resolved calls are added to ctx->calls,
+// unless the program is streamed.
+bool check_semantics(CompilerContext* ctx, NodeId root);
+bool analyze_ast(CompilerContext* ctx, NodeId root);  // Alias for check_semantics
 void print_symbol_table(SymbolTable* table);  // Print symbol table contents
-void report_semantic_error(const char* message, const char* name, int line_number);
-SemanticError get_last_semantic_error(void);
-void clear_semantic_error(void);
+void report_semantic_error(DiagnosticList* diagnostics, const char* message, const char* name,
+                           int line_number);
 
-// Type checking functions
-VarType get_expression_type(ASTNode* node, SymbolTable* table);
-bool check_type_compatibility(VarType expected, VarType actual, const char* context, int line_number);
+// Type checking functions. Names are interned pointers (see intern.h).
+VarType get_expression_type(const AST* ast, NodeId node);  // as annotated; NONE is unknown
+const Symbol* get_symbol(const SymbolTable* table, uint32_t ref);  // NULL for 0
+bool check_type_compatibility(DiagnosticList* diagnostics, VarType expected, VarType actual,
+                              const char* context, int line_number);
 void set_variable_type(SymbolTable* table, const char* name, VarType type);
 VarType get_variable_type(SymbolTable* table, const char* name);
 
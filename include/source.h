@@ -0,0 +1,29 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// A whole source file held in memory, followed by the two NUL sentinel bytes
+// flex needs to scan it in place (see yy_scan_buffer).
+typedef struct {
+    char* data;
+    size_t size;          // source bytes, not counting the sentinels
+    void* mapping;        // non-NULL when data is a private file mapping,
+                          // otherwise data is heap memory
+    size_t mapping_size;
+} SourceBuffer;
+
+// Map a regular file copy-on-write with sentinel padding. Returns false (with
+// errno set) when the file cannot be mapped, e.g. for pipes and terminals;
+// callers then fall back to reading through a FILE*.
+bool source_map_file(SourceBuffer* src, const char* path);
+
+// Read a whole stream into a padded heap buffer.
+bool source_read_stream(SourceBuffer* src, FILE* in);
+
+// Release whatever source_map_file or source_read_stream acquired.
+void source_release(SourceBuffer* src);
+
+#endif // SOURCE_H
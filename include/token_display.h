@@ -2,14 +2,26 @@
 #define TOKEN_DISPLAY_H
 
 #include "parser.tab.h"
+#include <stddef.h>
+#include <stdio.h>
 
-// Function to display token information
-void display_token(int token, const char* text, int line);
+// Token dump state: where it goes and how many tokens of each display
+// category (TOKEN_CAT_*, see tokens.h) have been shown so far.
+typedef struct {
+    FILE* out;      // NULL disables token tracing
+    int counts[5];
+} TokenDisplay;
 
 // Function to initialize token display
-void init_token_display(void);
+void init_token_display(TokenDisplay* display);
+
+// Function to display token information; text need not be NUL-terminated
+void display_token(TokenDisplay* display, int token, const char* text, int length, int line);
+
+// Print the per-category token counts (indexed by TOKEN_CAT_*)
+void print_token_statistics(FILE* out, const size_t counts[]);
 
 // Function to finalize token display
-void finalize_token_display(void);
+void finalize_token_display(TokenDisplay* display);
 
 #endif // TOKEN_DISPLAY_H 
\ No newline at end of file
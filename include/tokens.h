@@ -0,0 +1,72 @@
+#ifndef TOKENS_H
+#define TOKENS_H
+
+#include "intern.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// A whole source file lexed up front into parallel arrays. Token text is not
+// copied: each token is a byte range of the in-memory source it was lexed
+// from, plus the decoded value (NUMBER value, or intern id of an IDENTIFIER or
+// STRING).
+//
+// kind[i] holds the bison token code minus TOKEN_KIND_BASE, so it fits a
+// byte; kind 0 is the end-of-input token that always terminates the stream.
+#define TOKEN_KIND_BASE 256
+
+typedef struct {
+    uint8_t* kind;
+    uint32_t* offset;
+    uint32_t* length;
+    uint32_t* line;
+    int32_t* value;
+    size_t count;
+    size_t capacity;
+} TokenStream;
+
+// Display categories, in the order token_display.c lists them
+enum {
+    TOKEN_CAT_KEYWORD,
+    TOKEN_CAT_OPERATOR,
+    TOKEN_CAT_PUNCTUATION,
+    TOKEN_CAT_IDENTIFIER,
+    TOKEN_CAT_LITERAL,
+    TOKEN_CAT_COUNT
+};
+
+void token_stream_init(TokenStream* ts);
+void token_stream_free(TokenStream* ts);
+void token_stream_reserve(TokenStream* ts, size_t capacity);
+void token_stream_push(TokenStream* ts, int token, uint32_t offset, uint32_t length,
+                       uint32_t line, int32_t value);
+
+// Lex base[0..size) completely into ts, interning names into `names`
+// (defined in src/lexer.l). base must be followed by two NUL bytes, as for
+// scan_source_buffer().
+void lex_token_stream(Interner* names, TokenStream* ts, char* base, size_t size);
+
+// Same result as lex_token_stream(), lexing newline-aligned chunks of the
+// source on up to `threads` threads (0: one per online CPU). Inputs too small
+// to be worth splitting are lexed serially. Defined in src/lex_parallel.c.
+void lex_token_stream_parallel(Interner* names, TokenStream* ts, char* base, size_t size,
+                               int threads);
+
+// Make the context's parser read tokens from ts instead of its scanner; NULL
+// switches back to the scanner. The stream must outlive the parse, and its
+// names must have been interned into ctx->names.
+typedef struct CompilerContext CompilerContext;
+void token_stream_replay(CompilerContext* ctx, const TokenStream* ts);
+
+// The parser's token source: the replayed stream if one is set, else the
+// context's scanner.
+union YYSTYPE;
+int next_token(union YYSTYPE* lval, CompilerContext* ctx);
+
+// Token dump in the same format as the scanner's trace, followed by the
+// category statistics.
+void display_token_stream(FILE* out, const TokenStream* ts, const char* source);
+void token_stream_stats(const TokenStream* ts, size_t counts[TOKEN_CAT_COUNT]);
+
+#endif // TOKENS_H
@@ -1,105 +1,501 @@
-#include "globals.h"
-#include "lexer.h"
-#include "parser.tab.h"
+#include "context.h"
 #include "ast.h"
+#include "ast_bin.h"
+#include "callgraph.h"
 #include "semantic.h"
 #include "ir.h"
 #include "optimizer.h"
 #include "codegen.h"
+#include "token_display.h"
+#include "scanner.h"
+#include "source.h"
+#include "tokens.h"
+#include "intern.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 
-// Global variables are defined in globals.c, and included via globals.h
-extern FILE *yyin;
-extern void reset_lexer(void);
-extern SemanticError get_last_semantic_error(void);
+// Dumps selected with --emit. Without --emit every dump is produced, together
+// with the phase banners the GUI splits its tabs on.
+typedef enum {
+    EMIT_TOKENS = 1 << 0,
+    EMIT_AST    = 1 << 1,
+    EMIT_IR     = 1 << 2,
+    EMIT_OPT_IR = 1 << 3,
+    EMIT_ASM    = 1 << 4,
+    EMIT_ALL    = EMIT_TOKENS | EMIT_AST | EMIT_IR | EMIT_OPT_IR | EMIT_ASM,
+    EMIT_AST_BIN = 1 << 5   // binary AST file; only on request, and on its own
+} EmitFlags;
+
+typedef struct {
+    unsigned emit;          // EmitFlags
+    bool full_listing;      // no --emit given: legacy listing of every phase
+    bool quiet;             // -q: no banners or progress messages
+    bool prelex;            // --prelex: lex everything before parsing
+    int lex_threads;        // threads for the pre-lex; 0 means one per CPU
+    int check_threads;      // threads for checking function bodies; 0 means one per CPU
+    size_t max_errors;      // --max-errors: diagnostics reported; 0 means the default
+    bool mem_stats;         // --mem-stats: report AST and name storage on stderr
+    bool stream;            // --stream: compile each top-level statement as it is parsed
+    bool from_ast;          // --from-ast: the input is a binary AST, not source
+    const char* input_path; // NULL reads stdin
+    const char* output_path;
+} DriverOptions;
+
+static FILE* out = NULL;
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [options] [input_file]\n"
+            "  --emit=LIST  comma-separated dumps to produce: tokens, ast, ir,\n"
+            "               opt-ir, asm, none (default: all, with phase banners),\n"
+            "               or ast-bin alone to save the parsed AST for --from-ast\n"
+            "  -o FILE      write the emitted output to FILE instead of stdout\n"
+            "  -q           suppress phase banners and progress messages\n"
+            "  --prelex     lex the whole input into a token buffer, then parse it\n"
+            "  --lex-threads=N\n"
+            "               pre-lex large inputs on N threads (0: one per CPU);\n"
+            "               implies --prelex\n"
+            "  --check-threads=N\n"
+            "               check the function bodies of large programs on N\n"
+            "               threads (default 0: one per CPU)\n"
+            "  --max-errors=N\n"
+            "               report at most N errors (default %d); the rest are\n"
+            "               only counted\n"
+            "  --mem-stats  report AST and name storage after parsing (stderr)\n"
+            "  --stream     compile each top-level statement as soon as it has been\n"
+            "               read, without phase banners; for input arriving on stdin\n"
+            "  --from-ast   the input is an AST saved with --emit=ast-bin; skips\n"
+            "               lexing and parsing\n"
+            "  -h, --help   show this help\n",
+            prog, DIAGNOSTIC_LIMIT);
+}
+
+static bool parse_emit_list(const char* list, unsigned* emit) {
+    static const struct { const char* name; unsigned flag; } kinds[] = {
+        {"tokens", EMIT_TOKENS}, {"ast", EMIT_AST}, {"ir", EMIT_IR},
+        {"opt-ir", EMIT_OPT_IR}, {"asm", EMIT_ASM}, {"ast-bin", EMIT_AST_BIN}, {"none", 0}
+    };
+    *emit = 0;
+    while (*list) {
+        size_t len = strcspn(list, ",");
+        bool known = false;
+        for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+            if (strlen(kinds[i].name) == len && strncmp(kinds[i].name, list, len) == 0) {
+                *emit |= kinds[i].flag;
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            fprintf(stderr, "Unknown --emit kind: %.*s\n", (int)len, list);
+            return false;
+        }
+        list += len;
+        if (*list == ',') list++;
+    }
+    return true;
+}
+
+static bool parse_thread_count(const char* text, int* threads) {
+    char* end;
+    long n = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || n < 0 || n > 256) {
+        fprintf(stderr, "Invalid thread count: %s\n", text);
+        return false;
+    }
+    *threads = (int)n;
+    return true;
+}
+
+static bool parse_error_limit(const char* text, size_t* limit) {
+    char* end;
+    long n = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || n < 1 || n > 100000) {
+        fprintf(stderr, "Invalid error limit: %s\n", text);
+        return false;
+    }
+    *limit = (size_t)n;
+    return true;
+}
+
+static bool parse_args(int argc, char* argv[], DriverOptions* opts) {
+    opts->emit = EMIT_ALL;
+    opts->full_listing = true;
+    opts->quiet = false;
+    opts->prelex = false;
+    opts->lex_threads = 1;
+    opts->check_threads = 0;
+    opts->max_errors = 0;
+    opts->mem_stats = false;
+    opts->stream = false;
+    opts->from_ast = false;
+    opts->input_path = NULL;
+    opts->output_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strncmp(arg, "--emit=", 7) == 0) {
+            if (!parse_emit_list(arg + 7, &opts->emit)) return false;
+            opts->full_listing = false;
+        } else if (strcmp(arg, "-o") == 0) {
+            if (++i >= argc) {
+                fprintf(stderr, "-o requires a file name\n");
+                return false;
+            }
+            opts->output_path = argv[i];
+        } else if (strcmp(arg, "-q") == 0) {
+            opts->quiet = true;
+        } else if (strcmp(arg, "--prelex") == 0) {
+            opts->prelex = true;
+        } else if (strncmp(arg, "--lex-threads=", 14) == 0) {
+            if (!parse_thread_count(arg + 14, &opts->lex_threads)) return false;
+            opts->prelex = true;
+        } else if (strncmp(arg, "--check-threads=", 16) == 0) {
+            if (!parse_thread_count(arg + 16, &opts->check_threads)) return false;
+        } else if (strncmp(arg, "--max-errors=", 13) == 0) {
+            if (!parse_error_limit(arg + 13, &opts->max_errors)) return false;
+        } else if (strcmp(arg, "--mem-stats") == 0) {
+            opts->mem_stats = true;
+        } else if (strcmp(arg, "--stream") == 0) {
+            opts->stream = true;
+        } else if (strcmp(arg, "--from-ast") == 0) {
+            opts->from_ast = true;
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            return false;
+        } else if (arg[0] == '-' && arg[1] != '\0') {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return false;
+        } else if (!opts->input_path) {
+            opts->input_path = arg;
+        } else {
+            fprintf(stderr, "Only one input file may be given\n");
+            return false;
+        }
+    }
+    if (opts->stream && opts->prelex) {
+        fprintf(stderr, "--stream cannot be combined with --prelex or --lex-threads\n");
+        return false;
+    }
+    if (opts->from_ast && (opts->stream || opts->prelex)) {
+        fprintf(stderr, "--from-ast cannot be combined with --stream or --prelex\n");
+        return false;
+    }
+    if ((opts->emit & EMIT_AST_BIN) && (opts->emit != EMIT_AST_BIN || opts->stream)) {
+        fprintf(stderr, "--emit=ast-bin cannot be combined with other dumps or --stream\n");
+        return false;
+    }
+    return true;
+}
 
 void print_phase_header(const char *phase_name) {
-    printf("==============================\n");
-    printf(" Phase: %s\n", phase_name);
-    printf("==============================\n");
+    fprintf(out, "==============================\n");
+    fprintf(out, " Phase: %s\n", phase_name);
+    fprintf(out, "==============================\n");
+}
+
+// Print the diagnostics found since the last call, syntax and semantic errors
+// alike, on stdout as the compiler always has.
+static void print_new_diagnostics(const CompilerContext* ctx, size_t* printed) {
+    diagnostics_print(stdout, &ctx->diagnostics, printed);
+}
+
+static void print_dropped_diagnostics(const CompilerContext* ctx) {
+    if (ctx->diagnostics.dropped) {
+        printf("%zu more errors not shown\n", ctx->diagnostics.dropped);
+    }
+}
+
+// A phase banner is shown when the phase has a dump to show, or for every
+// phase in the full listing.
+static bool show_phase(const DriverOptions* opts, unsigned flag) {
+    return !opts->quiet && (opts->full_listing || (opts->emit & flag));
+}
+
+// --stream: each top-level statement runs through every phase as soon as the
+// parser has it, and its dumps are written straight away. Nodes and IR are
+// freed statement by statement, so memory follows the largest statement (a
+// function) rather than the program; only the symbol table and names persist.
+// After the first error, statements are still parsed and checked for further
+// errors, but no longer compiled.
+typedef struct {
+    const DriverOptions* opts;
+    bool failed;
+    size_t peak_nodes;
+    size_t printed;         // diagnostics printed so far
+} StreamState;
+
+static bool compile_streamed_statement(CompilerContext* ctx, NodeId statement, void* arg) {
+    StreamState* stream = arg;
+    const DriverOptions* opts = stream->opts;
+    if (ast_node_count(&ctx->ast) > stream->peak_nodes) {
+        stream->peak_nodes = ast_node_count(&ctx->ast);
+    }
+
+    if (opts->emit & EMIT_AST) {
+        print_ast(out, &ctx->ast, statement, 0);
+    }
+    bool ok = check_semantics(ctx, statement);
+    print_new_diagnostics(ctx, &stream->printed);
+    if (!ok || ctx->has_syntax_error) {
+        stream->failed = true;
+    }
+    if (stream->failed) {
+        return true;
+    }
+
+    IRProgram ir = {0};
+    generate_ir_statement(ctx, statement, &ir);
+    if (!ir_program_empty(&ir) && (opts->emit & EMIT_IR)) {
+        print_ir(out, &ir);
+    }
+    if (!ir_program_empty(&ir)) {
+        // Later statements may still read this one's variables
+        optimize_ir(&ir, (opts->emit & EMIT_OPT_IR) ? out : NULL, true);
+    }
+    if (!ir_program_empty(&ir) && (opts->emit & EMIT_ASM)) {
+        generate_code_statement(out, &ir);
+    }
+    ir_program_free(&ir);
+    fflush(out);
+    return true;
+}
+
+// Drive the push parser one token at a time; returns false on any error.
+static bool compile_stream(CompilerContext* ctx, const DriverOptions* opts) {
+    StreamState stream = { opts, false, 0, 0 };
+    ctx->on_statement = compile_streamed_statement;
+    ctx->on_statement_arg = &stream;
+
+    yypstate* parser = yypstate_new();
+    int status;
+    do {
+        YYSTYPE value;
+        int token = next_token(&value, ctx);
+        status = yypush_parse(parser, token, &value, ctx);
+    } while (status == YYPUSH_MORE);
+    yypstate_delete(parser);
+    print_new_diagnostics(ctx, &stream.printed);
+    print_dropped_diagnostics(ctx);
+    bool ok = status == 0 && !stream.failed && !ctx->has_syntax_error;
+    if (ok && (opts->emit & EMIT_ASM)) {
+        generate_code_end(out);
+    }
+
+    if (opts->emit & EMIT_TOKENS) {
+        finalize_token_display(&ctx->token_display);
+    }
+    if (opts->mem_stats) {
+        fprintf(stderr, "AST: at most %zu nodes per statement\n", stream.peak_nodes);
+        fprintf(stderr, "Names: %zu, %zu bytes\n",
+                intern_count(&ctx->names), intern_bytes_used(&ctx->names));
+    }
+    return ok;
 }
 
 int main(int argc, char *argv[]) {
-    if (argc > 1) {
-        yyin = fopen(argv[1], "r");
-        if (!yyin) {
-            perror(argv[1]);
+    DriverOptions opts;
+    if (!parse_args(argc, argv, &opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Regular files are mapped and scanned in place; anything that cannot be
+    // mapped (stdin, pipes) goes through flex's buffered FILE* reader, or is
+    // read into memory first when the whole input is pre-lexed or is a saved
+    // AST.
+    SourceBuffer source = {0};
+    FILE* input = NULL;
+    if (opts.input_path && !source_map_file(&source, opts.input_path)) {
+        input = fopen(opts.input_path, "r");
+        if (!input) {
+            perror(opts.input_path);
+            return 1;
+        }
+    } else if (!opts.input_path) {
+        input = stdin;
+    }
+    if (input && (opts.prelex || opts.from_ast) && !source_read_stream(&source, input)) {
+        perror(opts.input_path ? opts.input_path : "stdin");
+        return 1;
+    }
+
+    out = stdout;
+    if (opts.output_path) {
+        out = fopen(opts.output_path, "w");
+        if (!out) {
+            perror(opts.output_path);
             return 1;
         }
-    } else {
-        yyin = stdin;
     }
 
-    // Initialize symbol table
-    table = create_symbol_table();
+    // All compiler state lives in the context, symbol table included
+    CompilerContext ctx;
+    compiler_context_init(&ctx);
+    diagnostics_init(&ctx.diagnostics, opts.max_errors);
+    ctx.check_threads = opts.check_threads;
     bool compilation_has_error = false;
 
-    // 1. Lexical and Syntax Analysis
-    print_phase_header("Lexical and Syntax Analysis");
-    yyparse();
-    reset_lexer(); // Reset for next potential stages if interactive
+    if (opts.stream) {
+        if (opts.emit & EMIT_TOKENS) {
+            ctx.token_display.out = out;
+            ctx.scan.display = &ctx.token_display;
+        }
+        if (source.data) {
+            scan_source_buffer(&ctx, source.data, source.size + 2);
+        } else {
+            scan_source_stream(&ctx, input);
+        }
+        compilation_has_error = !compile_stream(&ctx, &opts);
+        if (input && input != stdin) {
+            fclose(input);
+        }
+        source_release(&source);
+        if (out != stdout) {
+            fclose(out);
+        }
+        compiler_context_free(&ctx);
+        return compilation_has_error ? 1 : 0;
+    }
+
+    // 1. Lexical and Syntax Analysis, unless a saved AST replaces both
+    if (!opts.from_ast && show_phase(&opts, EMIT_TOKENS)) {
+        print_phase_header("Lexical and Syntax Analysis");
+    }
+    TokenStream tokens;
+    token_stream_init(&tokens);
+    if (opts.from_ast) {
+        if (!ast_read_binary(&ctx.ast, &ctx.names, source.data, source.size, &ctx.root)) {
+            fprintf(stderr, "%s: not an AST file written by this version of the compiler\n",
+                    opts.input_path ? opts.input_path : "stdin");
+            compilation_has_error = true;
+        }
+    } else if (opts.prelex) {
+        lex_token_stream_parallel(&ctx.names, &tokens, source.data, source.size, opts.lex_threads);
+        if (opts.emit & EMIT_TOKENS) {
+            display_token_stream(out, &tokens, source.data);
+        }
+        token_stream_replay(&ctx, &tokens);
+    } else {
+        if (opts.emit & EMIT_TOKENS) {
+            ctx.token_display.out = out;
+            ctx.scan.display = &ctx.token_display;
+        }
+        if (source.data) {
+            scan_source_buffer(&ctx, source.data, source.size + 2);
+        } else {
+            scan_source_file(&ctx, input);
+        }
+    }
+    if (!opts.from_ast) {
+        yyparse(&ctx);
+        reset_lexer(&ctx); // Reset for next potential stages if interactive
+        if (!opts.prelex && !opts.full_listing && (opts.emit & EMIT_TOKENS)) {
+            finalize_token_display(&ctx.token_display);
+        }
+        // After a syntax error, root holds the statements that did parse
+        if (ctx.root) {
+            ctx.root = ast_relayout_preorder(&ctx.ast, ctx.root);
+        }
+    }
+    size_t printed = 0;
+    print_new_diagnostics(&ctx, &printed);
+    token_stream_free(&tokens);
+    if (opts.mem_stats) {
+        fprintf(stderr, "AST: %zu nodes, %zu bytes\n",
+                ast_node_count(&ctx.ast), ast_bytes_used(&ctx.ast));
+        fprintf(stderr, "Names: %zu, %zu bytes\n",
+                intern_count(&ctx.names), intern_bytes_used(&ctx.names));
+    }
 
-    if (has_syntax_error) {
+    if (ctx.has_syntax_error) {
         compilation_has_error = true;
     }
 
     // 2. Syntax Analysis (AST)
     if (!compilation_has_error) {
-        if (root) {
-            print_phase_header("Syntax Analysis (AST)");
-            print_ast(root, 0);
+        if (ctx.root) {
+            if (show_phase(&opts, EMIT_AST)) {
+                print_phase_header("Syntax Analysis (AST)");
+            }
+            if (opts.emit & EMIT_AST) {
+                print_ast(out, &ctx.ast, ctx.root, 0);
+            }
+            if ((opts.emit & EMIT_AST_BIN) &&
+                !ast_write_binary(out, &ctx.ast, ctx.root, &ctx.names)) {
+                perror(opts.output_path ? opts.output_path : "stdout");
+                compilation_has_error = true;
+            }
         } else {
             printf("No AST generated.\n");
             compilation_has_error = true; // No AST is an error condition
         }
     }
 
-    // 3. Semantic Analysis
-    if (!compilation_has_error) {
-        print_phase_header("Semantic Analysis");
-        if (!check_semantics(root, table)) {
+    // 3. Semantic Analysis. After syntax errors, the statements that did parse
+    // are still checked, so that one run reports every error.
+    if (!compilation_has_error || (ctx.has_syntax_error && ctx.root)) {
+        if (show_phase(&opts, 0)) {
+            print_phase_header("Semantic Analysis");
+        }
+        if (!check_semantics(&ctx, ctx.root)) {
             compilation_has_error = true;
-            SemanticError err = get_last_semantic_error();
-            if (err.has_error && err.message) {
-                printf("%s\n", err.message); // Print specific semantic error
-            }
+            print_new_diagnostics(&ctx, &printed);
         } else {
-            printf("✔ No semantic errors found.\n");
+            if (show_phase(&opts, 0)) {
+                fprintf(out, "✔ No semantic errors found.\n");
+            }
+            // Functions the program never calls are not compiled
+            size_t dead = eliminate_dead_functions(&ctx);
+            if (dead && show_phase(&opts, 0)) {
+                fprintf(out, "Removed %zu unreachable function%s.\n", dead, dead == 1 ? "" : "s");
+            }
         }
     }
+    print_dropped_diagnostics(&ctx);
 
-    IRInstruction* ir_code = NULL;
+    IRProgram ir = {0};
     // 4. Intermediate Representation (IR)
     if (!compilation_has_error) {
-        print_phase_header("Intermediate Representation (IR)");
-        ir_code = generate_ir(root);
-        if (ir_code) {
-            print_ir(ir_code);
-        } else {
-            printf("No IR generated.\n");
+        if (show_phase(&opts, EMIT_IR)) {
+            print_phase_header("Intermediate Representation (IR)");
+        }
+        generate_ir(&ctx, ctx.root, &ir);
+        if (opts.emit & EMIT_IR) {
+            if (!ir_program_empty(&ir)) {
+                print_ir(out, &ir);
+            } else if (!opts.quiet) {
+                fprintf(out, "No IR generated.\n");
+            }
         }
     }
-    
+
     // 5. Optimization
-    if (!compilation_has_error && ir_code) {
-        print_phase_header("Optimization");
-        optimize_ir(ir_code);
+    if (!compilation_has_error && !ir_program_empty(&ir)) {
+        if (show_phase(&opts, EMIT_OPT_IR)) {
+            print_phase_header("Optimization");
+        }
+        optimize_ir(&ir, (opts.emit & EMIT_OPT_IR) ? out : NULL, false);
     }
-    
+
     // 6. Code Generation
-    if (!compilation_has_error && ir_code) {
-        print_phase_header("Code Generation");
-        generate_code(ir_code);
+    if (!compilation_has_error && !ir_program_empty(&ir) && (opts.emit & EMIT_ASM)) {
+        if (show_phase(&opts, EMIT_ASM)) {
+            print_phase_header("Code Generation");
+        }
+        generate_code(out, &ir);
     }
 
-    if (yyin != stdin) {
-        fclose(yyin);
+    if (input && input != stdin) {
+        fclose(input);
+    }
+    source_release(&source);
+    if (out != stdout) {
+        fclose(out);
     }
-    // free_symbol_table(table);
-    // free_ir(ir_code);
-    // free_ast(root);
+    ir_program_free(&ir);
+    compiler_context_free(&ctx);
 
     return compilation_has_error ? 1 : 0;
-} 
\ No newline at end of file
+}
@@ -0,0 +1,76 @@
+#include "arena.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN _Alignof(max_align_t)
+#define BLOCK_SIZE (64 * 1024)
+
+struct ArenaBlock {
+    ArenaBlock* next;
+    size_t used;
+    size_t capacity;
+    _Alignas(max_align_t) char data[];
+};
+
+static ArenaBlock* new_block(size_t capacity) {
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + capacity);
+    if (!block) {
+        fprintf(stderr, "Error: out of memory in arena\n");
+        exit(1);
+    }
+    block->used = 0;
+    block->capacity = capacity;
+    return block;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    ArenaBlock* block = arena->blocks;
+    if (!block || block->capacity - block->used < size) {
+        if (size > BLOCK_SIZE / 4) {
+            // Big requests get a block of their own, kept behind the current
+            // one so its free space is not abandoned.
+            ArenaBlock* own = new_block(size);
+            if (block) {
+                own->next = block->next;
+                block->next = own;
+            } else {
+                own->next = NULL;
+                arena->blocks = own;
+            }
+            own->used = size;
+            arena->used += size;
+            arena->reserved += size;
+            return own->data;
+        }
+        block = new_block(BLOCK_SIZE);
+        block->next = arena->blocks;
+        arena->blocks = block;
+        arena->reserved += BLOCK_SIZE;
+    }
+    void* p = block->data + block->used;
+    block->used += size;
+    arena->used += size;
+    return p;
+}
+
+char* arena_strndup(Arena* arena, const char* text, size_t len) {
+    char* copy = arena_alloc(arena, len + 1);
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+void arena_release(Arena* arena) {
+    ArenaBlock* block = arena->blocks;
+    while (block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+    arena->used = 0;
+    arena->reserved = 0;
+}
@@ -2,352 +2,550 @@
 #include <stdlib.h>
 #include <string.h>
 
-static ASTNode* alloc_node(ASTNodeType type) {
-ASTNode* node = (ASTNode*)malloc(sizeof(ASTNode));
-node->type = type;
-return node;
+static void* xrealloc(void* p, size_t size) {
+    void* grown = realloc(p, size);
+    if (!grown) {
+        fprintf(stderr, "Error: out of memory for AST\n");
+        exit(1);
+    }
+    return grown;
+}
+
+static NodeId alloc_node(AST* ast, ASTNodeType type) {
+    if (ast->count == 0) ast->count = 1;  // skip the AST_NONE slot
+    if (ast->count >= ast->capacity) {
+        ast->capacity = ast->capacity ? ast->capacity * 2 : 1024;
+        ast->nodes = xrealloc(ast->nodes, ast->capacity * sizeof(ASTNode));
+    }
+    NodeId id = (NodeId)ast->count++;
+    ASTNode* node = &ast->nodes[id];
+    memset(node, 0, sizeof(ASTNode));
+    node->type = type;
+    node->value_type = (uint8_t)ast_fixed_type(type);
+    return id;
+}
+
+// Hash-consing. Numbers, identifiers and binary operations are looked up in
+// an open-addressing table over the node array before a new node is made, so
+// each distinct one exists once and is shared by every use.
+bool ast_is_shared(ASTNodeType type) {
+    return type == AST_NUMBER || type == AST_IDENTIFIER || type == AST_BINARY_OP;
+}
+
+static uint32_t shared_hash(const ASTNode* node) {
+    const uint64_t k = 0x9E3779B97F4A7C15ull;
+    uint64_t h = (uint64_t)node->type + 1;
+    switch (node->type) {
+        case AST_NUMBER:
+            h = h * k ^ (uint32_t)node->number.value;
+            break;
+        case AST_IDENTIFIER:
+            h = h * k ^ (uintptr_t)node->identifier.name;  // interned
+            h = h * k ^ node->identifier.scope;
+            break;
+        default:
+            h = h * k ^ node->binary.op;
+            h = h * k ^ node->binary.left;
+            h = h * k ^ node->binary.right;
+            break;
+    }
+    h *= k;
+    return (uint32_t)(h >> 32);
+}
+
+static bool shared_equal(const ASTNode* a, const ASTNode* b) {
+    if (a->type != b->type) return false;
+    switch (a->type) {
+        case AST_NUMBER: return a->number.value == b->number.value;
+        case AST_IDENTIFIER:
+            return a->identifier.name == b->identifier.name &&
+                   a->identifier.scope == b->identifier.scope;
+        default:
+            return a->binary.op == b->binary.op && a->binary.left == b->binary.left &&
+                   a->binary.right == b->binary.right;
+    }
+}
+
+static void shared_insert(AST* ast, NodeId id) {
+    size_t mask = ast->shared_slots - 1;
+    uint32_t hash = shared_hash(&ast->nodes[id]);
+    size_t i = hash & mask;
+    while (ast->shared[i].id) i = (i + 1) & mask;
+    ast->shared[i] = (ASTSharedSlot){ id, hash };
+    ast->shared_count++;
+}
+
+// Index every shareable node in the array from scratch
+static void shared_rebuild(AST* ast, size_t slots) {
+    free(ast->shared);
+    ast->shared = xrealloc(NULL, slots * sizeof(ASTSharedSlot));
+    memset(ast->shared, 0, slots * sizeof(ASTSharedSlot));
+    ast->shared_slots = slots;
+    ast->shared_count = 0;
+    for (size_t id = 1; id < ast->count; id++) {
+        if (ast_is_shared((ASTNodeType)ast->nodes[id].type)) shared_insert(ast, (NodeId)id);
+    }
+}
+
+// Double the index, moving the slots by their stored hashes
+static void shared_grow(AST* ast) {
+    size_t slots = ast->shared_slots ? ast->shared_slots * 2 : 1024;
+    ASTSharedSlot* grown = xrealloc(NULL, slots * sizeof(ASTSharedSlot));
+    memset(grown, 0, slots * sizeof(ASTSharedSlot));
+    for (size_t j = 0; j < ast->shared_slots; j++) {
+        ASTSharedSlot slot = ast->shared[j];
+        if (!slot.id) continue;
+        size_t i = slot.hash & (slots - 1);
+        while (grown[i].id) i = (i + 1) & (slots - 1);
+        grown[i] = slot;
+    }
+    free(ast->shared);
+    ast->shared = grown;
+    ast->shared_slots = slots;
 }
 
-ASTNode* create_var_decl_node(const char* name, ASTNode* value, int line_number) {
-ASTNode* node = alloc_node(AST_VAR_DECL);
+// The node equal to `key` if there is one; otherwise a new node made from it.
+// A shared node keeps the line of its first use.
+static NodeId share_node(AST* ast, const ASTNode* key) {
+    if ((ast->shared_count + 1) * 2 > ast->shared_slots) shared_grow(ast);
+    size_t mask = ast->shared_slots - 1;
+    uint32_t hash = shared_hash(key);
+    size_t i = hash & mask;
+    for (; ast->shared[i].id; i = (i + 1) & mask) {
+        NodeId candidate = ast->shared[i].id;
+        if (ast->shared[i].hash == hash && shared_equal(&ast->nodes[candidate], key)) {
+            return candidate;
+        }
+    }
+    NodeId id = alloc_node(ast, key->type);
+    ast->nodes[id] = *key;
+    ast->shared[i] = (ASTSharedSlot){ id, hash };
+    ast->shared_count++;
+    return id;
+}
+
+NodeId create_var_decl_node(AST* ast, const char* name, NodeId value, int line_number) {
+NodeId id = alloc_node(ast, AST_VAR_DECL);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
-node->var_decl.name = strdup(name);
+node->var_decl.name = name;
 node->var_decl.value = value;
-return node;
+return id;
 }
 
-ASTNode* create_assignment_node(const char* name, ASTNode* value, int line_number) {
-ASTNode* node = alloc_node(AST_ASSIGNMENT);
+NodeId create_assignment_node(AST* ast, const char* name, NodeId value, int line_number) {
+NodeId id = alloc_node(ast, AST_ASSIGNMENT);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
-node->assignment.name = strdup(name);
+node->assignment.name = name;
 node->assignment.value = value;
-return node;
+return id;
 }
 
-ASTNode* create_if_node(ASTNode* cond, ASTNode* then_branch, ASTNode* else_branch, int line_number) {
-ASTNode* node = alloc_node(AST_IF);
+NodeId create_if_node(AST* ast, NodeId cond, NodeId then_branch, NodeId else_branch, int line_number) {
+NodeId id = alloc_node(ast, AST_IF);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
 node->if_stmt.condition = cond;
 node->if_stmt.then_branch = then_branch;
 node->if_stmt.else_branch = else_branch;
-return node;
+return id;
 }
 
-ASTNode* create_for_node(ASTNode* init, ASTNode* cond, ASTNode* post, ASTNode* body, int line_number) {
-ASTNode* node = alloc_node(AST_FOR);
+NodeId create_for_node(AST* ast, NodeId init, NodeId cond, NodeId post, NodeId body, int line_number) {
+NodeId id = alloc_node(ast, AST_FOR);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
 node->for_loop.init = init;
 node->for_loop.cond = cond;
 node->for_loop.post = post;
 node->for_loop.body = body;
-return node;
+return id;
 }
 
-ASTNode* create_func_decl_node(const char* name, ASTNode* params, ASTNode* body, int line_number) {
-ASTNode* node = alloc_node(AST_FUNCTION_DECL);
+NodeId create_func_decl_node(AST* ast, const char* name, NodeId params, NodeId body, int line_number) {
+NodeId id = alloc_node(ast, AST_FUNCTION_DECL);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
-node->func_decl.name = strdup(name);
+node->func_decl.name = name;
 node->func_decl.params = params;
 node->func_decl.body = body;
-return node;
+return id;
 }
 
-ASTNode* create_func_call_node(const char* name, ASTNode* args, int line_number) {
-ASTNode* node = alloc_node(AST_FUNCTION_CALL);
+NodeId create_func_call_node(AST* ast, const char* name, NodeId args, int line_number) {
+NodeId id = alloc_node(ast, AST_FUNCTION_CALL);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
-node->func_call.name = strdup(name);
+node->func_call.name = name;
 node->func_call.args = args;
-return node;
+return id;
 }
 
-ASTNode* create_input_node(const char* name, int line_number) {
-ASTNode* node = alloc_node(AST_INPUT);
+NodeId create_input_node(AST* ast, const char* name, int line_number) {
+NodeId id = alloc_node(ast, AST_INPUT);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
-node->input.name = strdup(name);
-return node;
+node->input.name = name;
+return id;
 }
 
-ASTNode* create_publish_node(ASTNode* value, int line_number) {
-ASTNode* node = alloc_node(AST_PUBLISH);
+NodeId create_publish_node(AST* ast, NodeId value, int line_number) {
+NodeId id = alloc_node(ast, AST_PUBLISH);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
 node->publish.value = value;
-return node;
+return id;
 }
 
-ASTNode* create_binary_node(const char* op, ASTNode* left, ASTNode* right, int line_number) {
-ASTNode* node = alloc_node(AST_BINARY_OP);
-node->line_number = line_number;
-node->binary.op = strdup(op);
-node->binary.left = left;
-node->binary.right = right;
-return node;
+NodeId create_binary_node(AST* ast, ASTOperator op, NodeId left, NodeId right, int line_number) {
+ASTNode key = { .type = AST_BINARY_OP, .value_type = TYPE_INT, .line_number = line_number };
+key.binary.op = op;
+key.binary.left = left;
+key.binary.right = right;
+return share_node(ast, &key);
 }
 
-ASTNode* create_unary_node(const char* op, ASTNode* operand, int line_number) {
-ASTNode* node = alloc_node(AST_UNARY_OP);
+NodeId create_unary_node(AST* ast, ASTOperator op, NodeId operand, int line_number) {
+NodeId id = alloc_node(ast, AST_UNARY_OP);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
-node->unary.op = strdup(op);
+node->unary.op = op;
 node->unary.operand = operand;
-return node;
+return id;
 }
 
-ASTNode* create_number_node(int value, int line_number) {
-ASTNode* node = alloc_node(AST_NUMBER);
-node->line_number = line_number;
-node->number.value = value;
-return node;
+NodeId create_number_node(AST* ast, int value, int line_number) {
+ASTNode key = { .type = AST_NUMBER, .value_type = TYPE_INT, .line_number = line_number };
+key.number.value = value;
+return share_node(ast, &key);
 }
 
-ASTNode* create_string_node(const char* value, int line_number) {
-ASTNode* node = alloc_node(AST_STRING);
+NodeId create_string_node(AST* ast, const char* value, int line_number) {
+NodeId id = alloc_node(ast, AST_STRING);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
-node->string.value = strdup(value);
-return node;
+node->string.value = value;
+return id;
 }
 
-ASTNode* create_identifier_node(const char* name, int line_number) {
-ASTNode* node = alloc_node(AST_IDENTIFIER);
-node->line_number = line_number;
-node->identifier.name = strdup(name);
-return node;
+NodeId create_identifier_node(AST* ast, const char* name, int line_number) {
+ASTNode key = { .type = AST_IDENTIFIER, .value_type = TYPE_UNKNOWN, .line_number = line_number };
+key.identifier.name = name;
+key.identifier.scope = ast->scope;
+return share_node(ast, &key);
 }
 
-ASTNode* create_stmt_list_node(ASTNode* stmt, ASTNode* next, int line_number) {
-ASTNode* node = alloc_node(AST_STATEMENT_LIST);
+NodeId create_stmt_list_node(AST* ast, NodeId stmt, NodeId next, int line_number) {
+NodeId id = alloc_node(ast, AST_STATEMENT_LIST);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
 node->stmt_list.stmt = stmt;
 node->stmt_list.next = next;
-return node;
+return id;
 }
 
-ASTNode* create_expr_list_node(ASTNode* expr, ASTNode* next, int line_number) {
-ASTNode* node = alloc_node(AST_EXPR_LIST);
+NodeId create_expr_list_node(AST* ast, NodeId expr, NodeId next, int line_number) {
+NodeId id = alloc_node(ast, AST_EXPR_LIST);
+ASTNode* node = ast_node(ast, id);
 node->line_number = line_number;
 node->expr_list.expr = expr;
 node->expr_list.next = next;
-return node;
+return id;
 }
 
-ASTNode* create_identifier_list(const char* id, ASTNode* next, int line_number) {
-ASTNode* node = alloc_node(AST_ID_LIST);
+NodeId create_identifier_list(AST* ast, const char* id, NodeId next, int line_number) {
+NodeId list = alloc_node(ast, AST_ID_LIST);
+ASTNode* node = ast_node(ast, list);
 node->line_number = line_number;
-node->id_list.id = strdup(id);
+node->id_list.id = id;
 node->id_list.next = next;
-return node;
+return list;
 }
 
-void print_ast(ASTNode* node, int indent) {
-    if (!node) return;
+VarType ast_fixed_type(ASTNodeType type) {
+    switch (type) {
+        case AST_NUMBER:
+        case AST_BINARY_OP:
+            return TYPE_INT;
+        case AST_STRING:
+            return TYPE_STRING;
+        default:
+            return TYPE_UNKNOWN;
+    }
+}
 
-    // Print indentation
-    for (int i = 0; i < indent; i++) printf("|   ");
+uint32_t ast_open_scope(AST* ast) {
+    uint32_t outer = ast->scope;
+    ast->scope = ++ast->scope_count;
+    return outer;
+}
+
+void ast_close_scope(AST* ast, uint32_t outer) {
+    ast->scope = outer;
+}
 
+const char* ast_operator_symbol(ASTOperator op) {
+    static const char* const symbols[] = {
+        [AST_OP_ADD] = "+", [AST_OP_SUB] = "-", [AST_OP_MUL] = "*", [AST_OP_DIV] = "/",
+        [AST_OP_EQ] = "==", [AST_OP_NEQ] = "!=", [AST_OP_LT] = "<", [AST_OP_LEQ] = "<=",
+        [AST_OP_GT] = ">", [AST_OP_GEQ] = ">=", [AST_OP_AND] = "&&", [AST_OP_OR] = "||",
+        [AST_OP_NOT] = "!", [AST_OP_NEG] = "-",
+    };
+    return symbols[op];
+}
+
+int ast_children(ASTNode* node, NodeId* children[AST_MAX_CHILDREN]) {
+    int n = 0;
     switch (node->type) {
         case AST_VAR_DECL:
-            printf("Variable Declaration: %s\n", node->var_decl.name);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Value: ");
-            print_ast(node->var_decl.value, indent + 1);
+            children[n++] = &node->var_decl.value;
             break;
         case AST_ASSIGNMENT:
-            printf("Assignment: %s\n", node->assignment.name);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Value: ");
-            print_ast(node->assignment.value, indent + 1);
+            children[n++] = &node->assignment.value;
             break;
         case AST_IF:
-            printf("If Statement\n");
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Condition: ");
-            print_ast(node->if_stmt.condition, indent + 1);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Then Branch:\n");
-            print_ast(node->if_stmt.then_branch, indent + 2);
-            if (node->if_stmt.else_branch) {
-                for (int i = 0; i < indent; i++) printf("|   ");
-                printf("___ Else Branch:\n");
-                print_ast(node->if_stmt.else_branch, indent + 2);
-            }
+            children[n++] = &node->if_stmt.condition;
+            children[n++] = &node->if_stmt.then_branch;
+            children[n++] = &node->if_stmt.else_branch;
             break;
         case AST_FOR:
-            printf("For Loop\n");
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Initialization: ");
-            print_ast(node->for_loop.init, indent + 1);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Condition: ");
-            print_ast(node->for_loop.cond, indent + 1);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Update: ");
-            print_ast(node->for_loop.post, indent + 1);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Body:\n");
-            print_ast(node->for_loop.body, indent + 2);
+            children[n++] = &node->for_loop.init;
+            children[n++] = &node->for_loop.cond;
+            children[n++] = &node->for_loop.post;
+            children[n++] = &node->for_loop.body;
             break;
         case AST_FUNCTION_DECL:
-            printf("Function: %s\n", node->func_decl.name);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Parameters: ");
-            print_ast(node->func_decl.params, indent + 1);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Body:\n");
-            print_ast(node->func_decl.body, indent + 2);
+            children[n++] = &node->func_decl.params;
+            children[n++] = &node->func_decl.body;
             break;
         case AST_FUNCTION_CALL:
-            printf("Call: %s\n", node->func_call.name);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Arguments: ");
-            print_ast(node->func_call.args, indent + 1);
-            break;
-        case AST_INPUT:
-            printf("Input: %s\n", node->input.name);
+            children[n++] = &node->func_call.args;
             break;
         case AST_PUBLISH:
-            printf("Publish\n");
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Value: ");
-            print_ast(node->publish.value, indent + 1);
+            children[n++] = &node->publish.value;
             break;
         case AST_BINARY_OP:
-            printf("Binary Operation: %s\n", node->binary.op);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Left: ");
-            print_ast(node->binary.left, indent + 1);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Right: ");
-            print_ast(node->binary.right, indent + 1);
+            children[n++] = &node->binary.left;
+            children[n++] = &node->binary.right;
             break;
         case AST_UNARY_OP:
-            printf("Unary Operation: %s\n", node->unary.op);
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Operand: ");
-            print_ast(node->unary.operand, indent + 1);
-            break;
-        case AST_NUMBER:
-            printf("Number: %d\n", node->number.value);
-            break;
-        case AST_STRING:
-            printf("String: \"%s\"\n", node->string.value);
-            break;
-        case AST_IDENTIFIER:
-            printf("Identifier: %s\n", node->identifier.name);
+            children[n++] = &node->unary.operand;
             break;
         case AST_STATEMENT_LIST:
-            print_ast(node->stmt_list.stmt, indent);
-            if (node->stmt_list.next) {
-                print_ast(node->stmt_list.next, indent);
-            }
+            children[n++] = &node->stmt_list.stmt;
+            children[n++] = &node->stmt_list.next;
             break;
         case AST_EXPR_LIST:
-            if (indent == 0) printf("Arguments:\n");
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ ");
-            print_ast(node->expr_list.expr, indent + 1);
-            if (node->expr_list.next) {
-                print_ast(node->expr_list.next, indent);
-            }
+            children[n++] = &node->expr_list.expr;
+            children[n++] = &node->expr_list.next;
             break;
         case AST_ID_LIST:
-            printf("Identifier List\n");
-            for (int i = 0; i < indent; i++) printf("|   ");
-            printf("___ Identifier: %s\n", node->id_list.id);
-            if (node->id_list.next) {
-                for (int i = 0; i < indent; i++) printf("|   ");
-                printf("___ Next: ");
-                print_ast(node->id_list.next, indent + 1);
-            }
+            children[n++] = &node->id_list.next;
             break;
         default:
-            printf("Unknown Node Type\n");
             break;
     }
+    return n;
 }
 
-void free_ast(ASTNode* node) {
-    if (!node) return;
-
-    // Recursively free child nodes based on node type
-    switch (node->type) {
-        case AST_VAR_DECL:
-            free((char*)node->var_decl.name);
-            free_ast(node->var_decl.value);
-            break;
-
-        case AST_ASSIGNMENT:
-            free((char*)node->assignment.name);
-            free_ast(node->assignment.value);
-            break;
-
-        case AST_IF:
-            free_ast(node->if_stmt.condition);
-            free_ast(node->if_stmt.then_branch);
-            free_ast(node->if_stmt.else_branch);
-            break;
-
-        case AST_FOR:
-            free_ast(node->for_loop.init);
-            free_ast(node->for_loop.cond);
-            free_ast(node->for_loop.post);
-            free_ast(node->for_loop.body);
-            break;
-
-        case AST_FUNCTION_DECL:
-            free((char*)node->func_decl.name);
-            free_ast(node->func_decl.params);
-            free_ast(node->func_decl.body);
-            break;
-
-        case AST_FUNCTION_CALL:
-            free((char*)node->func_call.name);
-            free_ast(node->func_call.args);
-            break;
-
-        case AST_INPUT:
-            free((char*)node->input.name);
-            break;
-
-        case AST_PUBLISH:
-            free_ast(node->publish.value);
-            break;
-
-        case AST_BINARY_OP:
-            free((char*)node->binary.op);
-            free_ast(node->binary.left);
-            free_ast(node->binary.right);
-            break;
+NodeId ast_relayout_preorder(AST* ast, NodeId root) {
+    if (!root) return AST_NONE;
+
+    // Number the reachable nodes in preorder; a shared node is placed at its
+    // first use. Statement lists run as deep as the program is long, so the
+    // walk keeps its own stack.
+    NodeId* new_id = xrealloc(NULL, ast->count * sizeof(NodeId));
+    memset(new_id, 0, ast->count * sizeof(NodeId));
+    size_t capacity = 1024;
+    NodeId* stack = xrealloc(NULL, capacity * sizeof(NodeId));
+    size_t depth = 0;
+    NodeId next = 1;
+    stack[depth++] = root;
+    while (depth) {
+        NodeId id = stack[--depth];
+        if (new_id[id]) continue;
+        new_id[id] = next++;
+        NodeId* children[AST_MAX_CHILDREN];
+        int n = ast_children(&ast->nodes[id], children);
+        if (depth + AST_MAX_CHILDREN > capacity) {
+            capacity *= 2;
+            stack = xrealloc(stack, capacity * sizeof(NodeId));
+        }
+        while (n--) {
+            if (*children[n] && !new_id[*children[n]]) stack[depth++] = *children[n];
+        }
+    }
+    free(stack);
+
+    // Move every node to its new slot and renumber its links
+    ASTNode* relaid = xrealloc(NULL, ast->capacity * sizeof(ASTNode));
+    memset(&relaid[0], 0, sizeof(ASTNode));
+    for (size_t id = 1; id < ast->count; id++) {
+        if (!new_id[id]) continue;
+        ASTNode* node = &relaid[new_id[id]];
+        *node = ast->nodes[id];
+        NodeId* children[AST_MAX_CHILDREN];
+        int n = ast_children(node, children);
+        for (int i = 0; i < n; i++) *children[i] = new_id[*children[i]];
+    }
+    free(new_id);
+    free(ast->nodes);
+    ast->nodes = relaid;
+    ast->count = next;
+    if (ast->shared) shared_rebuild(ast, ast->shared_slots);
+    return 1;
+}
 
-        case AST_UNARY_OP:
-            free((char*)node->unary.op);
-            free_ast(node->unary.operand);
-            break;
+// print_ast() works through a stack of pending items instead of recursing,
+// so its stack use does not grow with the length of statement lists.
+typedef struct {
+    const char* label;  // text to print after the indentation, or NULL
+    NodeId node;        // node to print when label is NULL
+    int indent;
+} PrintItem;
+
+typedef struct {
+    PrintItem* items;
+    size_t count;
+    size_t capacity;
+} PrintStack;
+
+static void push_item(PrintStack* stack, const char* label, NodeId node, int indent) {
+    if (stack->count == stack->capacity) {
+        stack->capacity = stack->capacity ? stack->capacity * 2 : 64;
+        stack->items = xrealloc(stack->items, stack->capacity * sizeof(PrintItem));
+    }
+    stack->items[stack->count++] = (PrintItem){ label, node, indent };
+}
 
-        case AST_STRING:
-            free(node->string.value);
-            break;
+// Queue "label" at indent followed by child at child_indent. Items pop in
+// reverse, so a node pushes its last child first.
+static void push_child(PrintStack* stack, const char* label, int indent,
+                       NodeId child, int child_indent) {
+    push_item(stack, NULL, child, child_indent);
+    push_item(stack, label, AST_NONE, indent);
+}
 
-        case AST_IDENTIFIER:
-            free((char*)node->identifier.name);
-            break;
+static void print_indent(FILE* out, int indent) {
+    for (int i = 0; i < indent; i++) fprintf(out, "|   ");
+}
 
-        case AST_STATEMENT_LIST:
-            free_ast(node->stmt_list.stmt);
-            free_ast(node->stmt_list.next);
-            break;
+void print_ast(FILE* out, const AST* ast, NodeId root, int indent) {
+    PrintStack stack = { NULL, 0, 0 };
+    push_item(&stack, NULL, root, indent);
+
+    while (stack.count) {
+        PrintItem item = stack.items[--stack.count];
+        indent = item.indent;
+        if (item.label) {
+            print_indent(out, indent);
+            fputs(item.label, out);
+            continue;
+        }
+        if (!item.node) continue;
+        const ASTNode* node = ast_node(ast, item.node);
+
+        print_indent(out, indent);
+        switch (node->type) {
+            case AST_VAR_DECL:
+                fprintf(out, "Variable Declaration: %s\n", node->var_decl.name);
+                push_child(&stack, "___ Value: ", indent, node->var_decl.value, indent + 1);
+                break;
+            case AST_ASSIGNMENT:
+                fprintf(out, "Assignment: %s\n", node->assignment.name);
+                push_child(&stack, "___ Value: ", indent, node->assignment.value, indent + 1);
+                break;
+            case AST_IF:
+                fprintf(out, "If Statement\n");
+                if (node->if_stmt.else_branch) {
+                    push_child(&stack, "___ Else Branch:\n", indent, node->if_stmt.else_branch, indent + 2);
+                }
+                push_child(&stack, "___ Then Branch:\n", indent, node->if_stmt.then_branch, indent + 2);
+                push_child(&stack, "___ Condition: ", indent, node->if_stmt.condition, indent + 1);
+                break;
+            case AST_FOR:
+                fprintf(out, "For Loop\n");
+                push_child(&stack, "___ Body:\n", indent, node->for_loop.body, indent + 2);
+                push_child(&stack, "___ Update: ", indent, node->for_loop.post, indent + 1);
+                push_child(&stack, "___ Condition: ", indent, node->for_loop.cond, indent + 1);
+                push_child(&stack, "___ Initialization: ", indent, node->for_loop.init, indent + 1);
+                break;
+            case AST_FUNCTION_DECL:
+                fprintf(out, "Function: %s\n", node->func_decl.name);
+                push_child(&stack, "___ Body:\n", indent, node->func_decl.body, indent + 2);
+                push_child(&stack, "___ Parameters: ", indent, node->func_decl.params, indent + 1);
+                break;
+            case AST_FUNCTION_CALL:
+                fprintf(out, "Call: %s\n", node->func_call.name);
+                push_child(&stack, "___ Arguments: ", indent, node->func_call.args, indent + 1);
+                break;
+            case AST_INPUT:
+                fprintf(out, "Input: %s\n", node->input.name);
+                break;
+            case AST_PUBLISH:
+                fprintf(out, "Publish\n");
+                push_child(&stack, "___ Value: ", indent, node->publish.value, indent + 1);
+                break;
+            case AST_BINARY_OP:
+                fprintf(out, "Binary Operation: %s\n", ast_operator_symbol(node->binary.op));
+                push_child(&stack, "___ Right: ", indent, node->binary.right, indent + 1);
+                push_child(&stack, "___ Left: ", indent, node->binary.left, indent + 1);
+                break;
+            case AST_UNARY_OP:
+                fprintf(out, "Unary Operation: %s\n", ast_operator_symbol(node->unary.op));
+                push_child(&stack, "___ Operand: ", indent, node->unary.operand, indent + 1);
+                break;
+            case AST_NUMBER:
+                fprintf(out, "Number: %d\n", node->number.value);
+                break;
+            case AST_STRING:
+                fprintf(out, "String: \"%s\"\n", node->string.value);
+                break;
+            case AST_IDENTIFIER:
+                fprintf(out, "Identifier: %s\n", node->identifier.name);
+                break;
+            case AST_STATEMENT_LIST:
+                push_item(&stack, NULL, node->stmt_list.next, indent);
+                push_item(&stack, NULL, node->stmt_list.stmt, indent);
+                break;
+            case AST_EXPR_LIST:
+                if (indent == 0) fprintf(out, "Arguments:\n");
+                push_item(&stack, NULL, node->expr_list.next, indent);
+                push_child(&stack, "___ ", indent, node->expr_list.expr, indent + 1);
+                break;
+            case AST_ID_LIST:
+                fprintf(out, "Identifier List\n");
+                print_indent(out, indent);
+                fprintf(out, "___ Identifier: %s\n", node->id_list.id);
+                if (node->id_list.next) {
+                    push_child(&stack, "___ Next: ", indent, node->id_list.next, indent + 1);
+                }
+                break;
+            default:
+                fprintf(out, "Unknown Node Type\n");
+                break;
+        }
+    }
+    free(stack.items);
+}
 
-        case AST_EXPR_LIST:
-            free_ast(node->expr_list.expr);
-            free_ast(node->expr_list.next);
-            break;
+void ast_release(AST* ast) {
+    free(ast->nodes);
+    free(ast->shared);
+    memset(ast, 0, sizeof(*ast));
+}
 
-        case AST_ID_LIST:
-            free((char*)node->id_list.id);
-            free_ast(node->id_list.next);
-            break;
+void ast_clear(AST* ast) {
+    if (ast->count) ast->count = 1;
+    if (ast->shared) memset(ast->shared, 0, ast->shared_slots * sizeof(ASTSharedSlot));
+    ast->shared_count = 0;
+}
 
-        default:
-            break;
-    }
+size_t ast_node_count(const AST* ast) {
+    return ast->count ? ast->count - 1 : 0;
+}
 
-    // Finally, free the node itself
-    free(node);
-}
\ No newline at end of file
+size_t ast_bytes_used(const AST* ast) {
+    return ast->count * sizeof(ASTNode) + ast->shared_slots * sizeof(ASTSharedSlot);
+}
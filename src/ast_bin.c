@@ -0,0 +1,235 @@
+#include "ast_bin.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AST_BIN_BYTE_ORDER 0x01020304u
+#define AST_BIN_NO_NAME UINT32_MAX
+
+typedef struct {
+    char magic[4];          // "BAST"
+    uint32_t byte_order;    // AST_BIN_BYTE_ORDER as the writer stored it
+    uint32_t version;
+    uint32_t node_count;    // records, the AST_NONE slot included
+    uint32_t root;
+    uint32_t string_count;
+    uint32_t string_bytes;
+    uint32_t reserved;
+} BinHeader;
+
+typedef struct {
+    uint16_t type;          // ASTNodeType
+    uint16_t op;            // ASTOperator of binary and unary nodes
+    uint32_t value;         // string index of the name, or the number's value
+    uint32_t children[AST_MAX_CHILDREN];  // in ast_children() order
+} BinNode;
+
+static void* xrealloc(void* p, size_t size) {
+    void* grown = realloc(p, size ? size : 1);
+    if (!grown) {
+        fprintf(stderr, "Error: out of memory for binary AST\n");
+        exit(1);
+    }
+    return grown;
+}
+
+// Address of the node's name or string literal, for the kinds that have one
+static const char** node_name(ASTNode* node) {
+    switch (node->type) {
+        case AST_VAR_DECL: return &node->var_decl.name;
+        case AST_ASSIGNMENT: return &node->assignment.name;
+        case AST_FUNCTION_DECL: return &node->func_decl.name;
+        case AST_FUNCTION_CALL: return &node->func_call.name;
+        case AST_INPUT: return &node->input.name;
+        case AST_STRING: return &node->string.value;
+        case AST_IDENTIFIER: return &node->identifier.name;
+        case AST_ID_LIST: return &node->id_list.id;
+        default: return NULL;
+    }
+}
+
+bool ast_write_binary(FILE* out, const AST* ast, NodeId root, const Interner* names) {
+    size_t count = ast->count ? ast->count : 1;
+    BinNode* records = xrealloc(NULL, count * sizeof(BinNode));
+    uint32_t* lines = xrealloc(NULL, count * sizeof(uint32_t));
+    memset(records, 0, count * sizeof(BinNode));
+    memset(lines, 0, count * sizeof(uint32_t));
+
+    // Each distinct name is stored once, in order of first use. Names are
+    // interned, so the intern id tells whether one has been seen.
+    size_t id_count = intern_count(names);
+    uint32_t* string_of = xrealloc(NULL, (id_count + 1) * sizeof(uint32_t));  // index + 1
+    memset(string_of, 0, (id_count + 1) * sizeof(uint32_t));
+    const char** strings = xrealloc(NULL, count * sizeof(const char*));
+    uint32_t* offsets = xrealloc(NULL, (count + 1) * sizeof(uint32_t));
+    uint32_t string_count = 0;
+    offsets[0] = 0;
+
+    for (size_t id = 1; id < count; id++) {
+        ASTNode node = ast->nodes[id];
+        BinNode* record = &records[id];
+        record->type = (uint16_t)node.type;
+        if (node.type == AST_BINARY_OP) record->op = (uint16_t)node.binary.op;
+        if (node.type == AST_UNARY_OP) record->op = (uint16_t)node.unary.op;
+        if (node.type == AST_NUMBER) record->value = (uint32_t)node.number.value;
+
+        const char** name = node_name(&node);
+        if (name) {
+            record->value = AST_BIN_NO_NAME;
+            if (*name) {
+                InternId name_id = intern_id(*name);
+                if (!string_of[name_id]) {
+                    strings[string_count] = *name;
+                    offsets[string_count + 1] = offsets[string_count] + (uint32_t)strlen(*name);
+                    string_of[name_id] = ++string_count;
+                }
+                record->value = string_of[name_id] - 1;
+            }
+        }
+
+        NodeId* children[AST_MAX_CHILDREN];
+        int n = ast_children(&node, children);
+        for (int i = 0; i < n; i++) record->children[i] = *children[i];
+        lines[id] = (uint32_t)node.line_number;
+    }
+
+    BinHeader header = {
+        { 'B', 'A', 'S', 'T' }, AST_BIN_BYTE_ORDER, AST_BIN_VERSION,
+        (uint32_t)count, root, string_count, offsets[string_count], 0
+    };
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(records, sizeof(BinNode), count, out);
+    fwrite(lines, sizeof(uint32_t), count, out);
+    fwrite(offsets, sizeof(uint32_t), string_count + 1, out);
+    for (uint32_t i = 0; i < string_count; i++) {
+        fwrite(strings[i], 1, offsets[i + 1] - offsets[i], out);
+    }
+
+    free(records);
+    free(lines);
+    free(string_of);
+    free(strings);
+    free(offsets);
+    return !ferror(out);
+}
+
+// The walkers follow child links until they run out, so a loaded AST must not
+// contain a cycle. Depth-first search from every node with white/grey/black
+// marks: a link to a grey node closes a cycle.
+static bool links_acyclic(AST* ast) {
+    enum { WHITE, GREY, BLACK };
+    typedef struct { NodeId id; int next; } Frame;
+    uint8_t* mark = xrealloc(NULL, ast->count);
+    memset(mark, WHITE, ast->count);
+    Frame* stack = xrealloc(NULL, ast->count * sizeof(Frame));  // grey nodes only
+    bool ok = true;
+    for (size_t start = 1; ok && start < ast->count; start++) {
+        if (mark[start] != WHITE) continue;
+        size_t depth = 0;
+        stack[depth++] = (Frame){ (NodeId)start, 0 };
+        mark[start] = GREY;
+        while (ok && depth) {
+            Frame* frame = &stack[depth - 1];
+            NodeId* children[AST_MAX_CHILDREN];
+            int n = ast_children(&ast->nodes[frame->id], children);
+            if (frame->next == n) {
+                mark[frame->id] = BLACK;
+                depth--;
+                continue;
+            }
+            NodeId child = *children[frame->next++];
+            if (!child || mark[child] == BLACK) continue;
+            if (mark[child] == GREY) {
+                ok = false;
+            } else {
+                mark[child] = GREY;
+                stack[depth++] = (Frame){ child, 0 };
+            }
+        }
+    }
+    free(stack);
+    free(mark);
+    return ok;
+}
+
+bool ast_read_binary(AST* ast, Interner* names, const void* data, size_t size, NodeId* root) {
+    *root = AST_NONE;
+    BinHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, "BAST", 4) != 0 || header.byte_order != AST_BIN_BYTE_ORDER ||
+        header.version != AST_BIN_VERSION || header.node_count == 0 ||
+        header.root >= header.node_count) {
+        return false;
+    }
+
+    // Every section must fit the data exactly before any of it is read
+    uint64_t nodes_at = sizeof(BinHeader);
+    uint64_t lines_at = nodes_at + (uint64_t)header.node_count * sizeof(BinNode);
+    uint64_t offsets_at = lines_at + (uint64_t)header.node_count * sizeof(uint32_t);
+    uint64_t strings_at = offsets_at + ((uint64_t)header.string_count + 1) * sizeof(uint32_t);
+    if (strings_at + header.string_bytes != size) return false;
+
+    const char* base = data;
+    const BinNode* records = (const BinNode*)(base + nodes_at);
+    const uint32_t* lines = (const uint32_t*)(base + lines_at);
+    const uint32_t* offsets = (const uint32_t*)(base + offsets_at);
+    const char* bytes = base + strings_at;
+
+    if (offsets[0] != 0 || offsets[header.string_count] != header.string_bytes) return false;
+    for (uint32_t i = 0; i < header.string_count; i++) {
+        if (offsets[i + 1] < offsets[i]) return false;
+    }
+    const char** strings = xrealloc(NULL, (header.string_count + 1) * sizeof(const char*));
+    for (uint32_t i = 0; i < header.string_count; i++) {
+        strings[i] = intern_n(names, bytes + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    size_t count = header.node_count;
+    ast->nodes = xrealloc(ast->nodes, count * sizeof(ASTNode));
+    ast->capacity = count;
+    ast->count = count;
+    memset(ast->nodes, 0, count * sizeof(ASTNode));
+
+    bool ok = true;
+    for (size_t id = 1; ok && id < count; id++) {
+        const BinNode* record = &records[id];
+        ASTNode* node = &ast->nodes[id];
+        if (record->type > AST_ID_LIST || record->op > AST_OP_NEG) {
+            ok = false;
+            break;
+        }
+        node->type = (ASTNodeType)record->type;
+        node->value_type = (uint8_t)ast_fixed_type(node->type);
+        node->line_number = (int)lines[id];
+        if (node->type == AST_BINARY_OP) node->binary.op = (ASTOperator)record->op;
+        if (node->type == AST_UNARY_OP) node->unary.op = (ASTOperator)record->op;
+        if (node->type == AST_NUMBER) node->number.value = (int)record->value;
+
+        // Every kind with a name needs one; later passes never check for NULL
+        const char** name = node_name(node);
+        if (name) {
+            if (record->value >= header.string_count) {
+                ok = false;
+                break;
+            }
+            *name = strings[record->value];
+        }
+
+        NodeId* children[AST_MAX_CHILDREN];
+        int n = ast_children(node, children);
+        for (int i = 0; i < n; i++) {
+            NodeId child = record->children[i];
+            if (child >= count) ok = false;
+            *children[i] = child;
+        }
+    }
+    free(strings);
+
+    if (!ok || !links_acyclic(ast)) {
+        ast_release(ast);
+        return false;
+    }
+    *root = header.root;
+    return true;
+}
@@ -0,0 +1,108 @@
+#include "callgraph.h"
+#include "context.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void* xrealloc(void* p, size_t size) {
+    void* grown = realloc(p, size ? size : 1);
+    if (!grown) {
+        fprintf(stderr, "Error: out of memory for call graph\n");
+        exit(1);
+    }
+    return grown;
+}
+
+void call_graph_add(CallGraph* graph, NodeId caller, NodeId callee) {
+    if (graph->count == graph->capacity) {
+        graph->capacity = graph->capacity ? graph->capacity * 2 : 64;
+        graph->edges = xrealloc(graph->edges, graph->capacity * sizeof(CallEdge));
+    }
+    graph->edges[graph->count++] = (CallEdge){ caller, callee };
+}
+
+void call_graph_append(CallGraph* graph, const CallGraph* from) {
+    for (size_t i = 0; i < from->count; i++) {
+        call_graph_add(graph, from->edges[i].caller, from->edges[i].callee);
+    }
+}
+
+void call_graph_release(CallGraph* graph) {
+    free(graph->edges);
+    memset(graph, 0, sizeof(*graph));
+}
+
+static int compare_caller(const void* a, const void* b) {
+    NodeId x = ((const CallEdge*)a)->caller;
+    NodeId y = ((const CallEdge*)b)->caller;
+    return (x > y) - (x < y);
+}
+
+// Index of the first edge of caller in edges sorted by caller
+static size_t first_edge(const CallGraph* graph, NodeId caller) {
+    size_t lo = 0, hi = graph->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (graph->edges[mid].caller < caller) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// A statement list entry holding the declaration of an unreachable function
+static bool dead_entry(const AST* ast, const uint8_t* live, NodeId id) {
+    const ASTNode* entry = ast_node(ast, id);
+    if (entry->type != AST_STATEMENT_LIST || !entry->stmt_list.stmt) return false;
+    NodeId stmt = entry->stmt_list.stmt;
+    return ast_node(ast, stmt)->type == AST_FUNCTION_DECL && !live[stmt];
+}
+
+static NodeId skip_dead(const AST* ast, const uint8_t* live, NodeId id, size_t* removed) {
+    while (id && dead_entry(ast, live, id)) {
+        id = ast_node(ast, id)->stmt_list.next;
+        ++*removed;
+    }
+    return id;
+}
+
+size_t eliminate_dead_functions(CompilerContext* ctx) {
+    AST* ast = &ctx->ast;
+    CallGraph* graph = &ctx->calls;
+    if (!ctx->root) return 0;
+
+    // Walk the calls from the program's own statements (caller AST_NONE) on
+    if (graph->count) qsort(graph->edges, graph->count, sizeof(CallEdge), compare_caller);
+    uint8_t* live = xrealloc(NULL, ast->count);
+    memset(live, 0, ast->count);
+    NodeId* work = xrealloc(NULL, ast->count * sizeof(NodeId));
+    size_t work_count = 0;
+    NodeId caller = AST_NONE;
+    for (;;) {
+        for (size_t i = first_edge(graph, caller);
+             i < graph->count && graph->edges[i].caller == caller; i++) {
+            NodeId callee = graph->edges[i].callee;
+            if (!live[callee]) {
+                live[callee] = 1;
+                work[work_count++] = callee;
+            }
+        }
+        if (!work_count) break;
+        caller = work[--work_count];
+    }
+    free(work);
+
+    // Statement lists are never shared, so each entry is linked from exactly
+    // one child slot (or is the root): cutting dead entries out of every slot
+    // removes each of them once.
+    size_t removed = 0;
+    ctx->root = skip_dead(ast, live, ctx->root, &removed);
+    for (size_t id = 1; id < ast->count; id++) {
+        NodeId* children[AST_MAX_CHILDREN];
+        int n = ast_children(&ast->nodes[id], children);
+        for (int i = 0; i < n; i++) {
+            *children[i] = skip_dead(ast, live, *children[i], &removed);
+        }
+    }
+    free(live);
+    return removed;
+}
@@ -0,0 +1,283 @@
+#include "cfg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void* xrealloc(void* p, size_t size) {
+    void* grown = realloc(p, size ? size : 1);
+    if (!grown) {
+        fprintf(stderr, "Error: out of memory for control-flow graph\n");
+        exit(1);
+    }
+    return grown;
+}
+
+static bool ends_block(IROp op) {
+    return ir_is_jump(op) || op == IR_RETURN;
+}
+
+// Cut the code into blocks and link each to its successors
+static void find_blocks(CFG* cfg, const IRProgram* program) {
+    const IRInstruction* code = program->code;
+    size_t count = 0;
+    for (size_t i = 0; i < program->count; i++) {
+        if (i == 0 || code[i].op == IR_LABEL || ends_block(code[i - 1].op)) count++;
+    }
+    cfg->blocks = xrealloc(NULL, count * sizeof(IRBlock));
+    cfg->block_count = count;
+
+    // Labels are numbered across the whole compilation, so the map from
+    // label to block covers the largest label used here
+    uint32_t label_limit = 0;
+    for (size_t i = 0; i < program->count; i++) {
+        if (code[i].op == IR_LABEL && ir_operand_index(code[i].result) >= label_limit) {
+            label_limit = ir_operand_index(code[i].result) + 1;
+        }
+    }
+    uint32_t* block_of_label = xrealloc(NULL, (label_limit ? label_limit : 1) * sizeof(uint32_t));
+
+    size_t b = 0;
+    for (size_t i = 0; i < program->count; i++) {
+        if (i == 0 || code[i].op == IR_LABEL || ends_block(code[i - 1].op)) {
+            if (i) cfg->blocks[b - 1].end = i;
+            cfg->blocks[b++] = (IRBlock){ .first = i, .succ = { CFG_NONE, CFG_NONE },
+                                          .rpo = CFG_NONE, .idom = CFG_NONE, .loop = CFG_NONE };
+        }
+        if (code[i].op == IR_LABEL) {
+            block_of_label[ir_operand_index(code[i].result)] = (uint32_t)b - 1;
+        }
+    }
+    if (count) cfg->blocks[count - 1].end = program->count;
+
+    for (b = 0; b < count; b++) {
+        IRBlock* block = &cfg->blocks[b];
+        const IRInstruction* last = &code[block->end - 1];
+        if (ir_is_jump(last->op)) {
+            block->succ[block->succ_count++] = block_of_label[ir_operand_index(last->result)];
+        }
+        bool falls_through = last->op != IR_GOTO && last->op != IR_RETURN;
+        if (falls_through && b + 1 < count && (!block->succ_count || block->succ[0] != b + 1)) {
+            block->succ[block->succ_count++] = (uint32_t)b + 1;
+        }
+    }
+    free(block_of_label);
+}
+
+static void find_preds(CFG* cfg) {
+    size_t edges = 0;
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        const IRBlock* block = &cfg->blocks[b];
+        for (uint32_t s = 0; s < block->succ_count; s++) cfg->blocks[block->succ[s]].pred_count++;
+        edges += block->succ_count;
+    }
+    uint32_t at = 0;
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        cfg->blocks[b].pred_first = at;
+        at += cfg->blocks[b].pred_count;
+        cfg->blocks[b].pred_count = 0;
+    }
+    cfg->preds = xrealloc(NULL, edges * sizeof(uint32_t));
+    for (size_t b = 0; b < cfg->block_count; b++) {
+        const IRBlock* block = &cfg->blocks[b];
+        for (uint32_t s = 0; s < block->succ_count; s++) {
+            IRBlock* succ = &cfg->blocks[block->succ[s]];
+            cfg->preds[succ->pred_first + succ->pred_count++] = (uint32_t)b;
+        }
+    }
+}
+
+// Depth-first search from the entry on an explicit stack; blocks are
+// numbered in postorder and then reversed
+static void find_rpo(CFG* cfg) {
+    typedef struct { uint32_t block; uint32_t next; } Frame;
+    size_t count = cfg->block_count;
+    cfg->rpo = xrealloc(NULL, count * sizeof(uint32_t));
+    cfg->rpo_count = 0;
+    if (!count) return;
+
+    Frame* stack = xrealloc(NULL, count * sizeof(Frame));
+    uint8_t* seen = xrealloc(NULL, count);
+    memset(seen, 0, count);
+    size_t depth = 0;
+    stack[depth++] = (Frame){ 0, 0 };
+    seen[0] = 1;
+    while (depth) {
+        Frame* frame = &stack[depth - 1];
+        const IRBlock* block = &cfg->blocks[frame->block];
+        if (frame->next == block->succ_count) {
+            cfg->rpo[cfg->rpo_count++] = frame->block;
+            depth--;
+            continue;
+        }
+        uint32_t succ = block->succ[frame->next++];
+        if (!seen[succ]) {
+            seen[succ] = 1;
+            stack[depth++] = (Frame){ succ, 0 };
+        }
+    }
+    free(stack);
+    free(seen);
+
+    for (size_t i = 0, j = cfg->rpo_count; i + 1 < j; i++, j--) {
+        uint32_t swap = cfg->rpo[i];
+        cfg->rpo[i] = cfg->rpo[j - 1];
+        cfg->rpo[j - 1] = swap;
+    }
+    for (size_t i = 0; i < cfg->rpo_count; i++) cfg->blocks[cfg->rpo[i]].rpo = (uint32_t)i;
+}
+
+// Cooper, Harvey and Kennedy's iterative algorithm: walk the blocks in
+// reverse postorder, meeting the dominators of the processed predecessors,
+// until nothing changes
+static uint32_t intersect(const CFG* cfg, uint32_t a, uint32_t b) {
+    while (a != b) {
+        while (cfg->blocks[a].rpo > cfg->blocks[b].rpo) a = cfg->blocks[a].idom;
+        while (cfg->blocks[b].rpo > cfg->blocks[a].rpo) b = cfg->blocks[b].idom;
+    }
+    return a;
+}
+
+static void find_dominators(CFG* cfg) {
+    if (!cfg->rpo_count) return;
+    cfg->blocks[0].idom = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < cfg->rpo_count; i++) {
+            IRBlock* block = &cfg->blocks[cfg->rpo[i]];
+            uint32_t idom = CFG_NONE;
+            for (uint32_t p = 0; p < block->pred_count; p++) {
+                uint32_t pred = cfg->preds[block->pred_first + p];
+                if (cfg->blocks[pred].idom == CFG_NONE) continue;
+                idom = idom == CFG_NONE ? pred : intersect(cfg, pred, idom);
+            }
+            if (block->idom != idom) {
+                block->idom = idom;
+                changed = true;
+            }
+        }
+    }
+}
+
+bool cfg_dominates(const CFG* cfg, uint32_t a, uint32_t b) {
+    if (cfg->blocks[a].rpo == CFG_NONE || cfg->blocks[b].rpo == CFG_NONE) return false;
+    // Dominators come before the blocks they dominate in reverse postorder
+    while (cfg->blocks[b].rpo > cfg->blocks[a].rpo) b = cfg->blocks[b].idom;
+    return a == b;
+}
+
+static int compare_block(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_size(const void* a, const void* b) {
+    uint32_t x = ((const CFGLoop*)a)->block_count;
+    uint32_t y = ((const CFGLoop*)b)->block_count;
+    return (x > y) - (x < y);
+}
+
+// A back edge goes to a block that dominates its source, and makes that
+// block a loop header
+static void find_loops(CFG* cfg) {
+    size_t count = cfg->block_count;
+    uint8_t* in_loop = xrealloc(NULL, count);
+    memset(in_loop, 0, count);
+    uint32_t* work = xrealloc(NULL, count * sizeof(uint32_t));
+    size_t block_total = 0, block_capacity = 0, loop_capacity = 0;
+
+    // Headers in reverse postorder, so the loops come out in a fixed order
+    for (size_t i = 0; i < cfg->rpo_count; i++) {
+        uint32_t header = cfg->rpo[i];
+        const IRBlock* head = &cfg->blocks[header];
+        bool back_edge = false;
+        for (uint32_t p = 0; p < head->pred_count; p++) {
+            if (cfg_dominates(cfg, header, cfg->preds[head->pred_first + p])) back_edge = true;
+        }
+        if (!back_edge) continue;
+
+        // The header, and everything that reaches a back edge without
+        // passing it. Blocks are listed straight into loop_blocks as they
+        // are found. Unreachable predecessors come from outside the graph.
+        if (block_total + count > block_capacity) {
+            block_capacity = block_total + count > 2 * block_capacity ? block_total + count : 2 * block_capacity;
+            cfg->loop_blocks = xrealloc(cfg->loop_blocks, block_capacity * sizeof(uint32_t));
+        }
+        uint32_t* blocks = cfg->loop_blocks + block_total;
+        uint32_t size = 0;
+        size_t work_count = 0;
+        in_loop[header] = 1;
+        blocks[size++] = header;
+        for (uint32_t p = 0; p < head->pred_count; p++) {
+            uint32_t pred = cfg->preds[head->pred_first + p];
+            if (!in_loop[pred] && cfg_dominates(cfg, header, pred)) {
+                in_loop[pred] = 1;
+                blocks[size++] = pred;
+                work[work_count++] = pred;
+            }
+        }
+        while (work_count) {
+            const IRBlock* block = &cfg->blocks[work[--work_count]];
+            for (uint32_t p = 0; p < block->pred_count; p++) {
+                uint32_t pred = cfg->preds[block->pred_first + p];
+                if (!in_loop[pred] && cfg->blocks[pred].rpo != CFG_NONE) {
+                    in_loop[pred] = 1;
+                    blocks[size++] = pred;
+                    work[work_count++] = pred;
+                }
+            }
+        }
+        for (uint32_t k = 0; k < size; k++) in_loop[blocks[k]] = 0;
+        qsort(blocks, size, sizeof(uint32_t), compare_block);
+
+        if (cfg->loop_count == loop_capacity) {
+            loop_capacity = loop_capacity ? loop_capacity * 2 : 16;
+            cfg->loops = xrealloc(cfg->loops, loop_capacity * sizeof(CFGLoop));
+        }
+        cfg->loops[cfg->loop_count++] = (CFGLoop){ header, CFG_NONE, 1, (uint32_t)block_total, size };
+        block_total += size;
+    }
+    free(in_loop);
+    free(work);
+
+    // Nesting: going from small loops to large ones, each block is claimed
+    // by the first, innermost, loop that contains it, and a larger loop
+    // around a claimed block encloses the outermost loop found there so far
+    if (cfg->loop_count) qsort(cfg->loops, cfg->loop_count, sizeof(CFGLoop), compare_size);
+    for (uint32_t l = 0; l < cfg->loop_count; l++) {
+        const CFGLoop* loop = &cfg->loops[l];
+        for (uint32_t k = 0; k < loop->block_count; k++) {
+            IRBlock* block = &cfg->blocks[cfg->loop_blocks[loop->block_first + k]];
+            if (block->loop == CFG_NONE) {
+                block->loop = l;
+                continue;
+            }
+            uint32_t top = block->loop;
+            while (cfg->loops[top].parent != CFG_NONE) top = cfg->loops[top].parent;
+            if (top != l) cfg->loops[top].parent = l;
+        }
+    }
+    // Parents come after their children
+    for (size_t l = cfg->loop_count; l-- > 0;) {
+        CFGLoop* loop = &cfg->loops[l];
+        if (loop->parent != CFG_NONE) loop->depth = cfg->loops[loop->parent].depth + 1;
+    }
+}
+
+void cfg_build(CFG* cfg, const IRProgram* program) {
+    memset(cfg, 0, sizeof(*cfg));
+    find_blocks(cfg, program);
+    find_preds(cfg);
+    find_rpo(cfg);
+    find_dominators(cfg);
+    find_loops(cfg);
+}
+
+void cfg_free(CFG* cfg) {
+    free(cfg->blocks);
+    free(cfg->preds);
+    free(cfg->rpo);
+    free(cfg->loops);
+    free(cfg->loop_blocks);
+    memset(cfg, 0, sizeof(*cfg));
+}
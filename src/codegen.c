@@ -4,24 +4,47 @@
 #include <stdlib.h>
 #include <string.h>
 
-// This is a forward declaration, as print_operand is in ir.c but useful for debugging here
-void print_operand(IROperand op);
+// --- Calling convention ---
+// The caller pushes the arguments in order, calls, and pops them again; the
+// value of the call comes back in R0. A function keeps its parameters, locals
+// and temps in a frame addressed from FP:
+//
+//   [FP+2] ..    the arguments, the last one nearest
+//   [FP+1]       return address
+//   [FP]         the caller's FP
+//   [FP-1] ..    the locals, then the temps
+//
+// The program's own variables and temps are named memory cells.
+static void print_location(FILE* out, const IRProgram* program, IROperand op) {
+    uint32_t index = ir_operand_index(op);
+    uint32_t locals = (uint32_t)program->variable_count - program->param_count;
+    if (program->name && ir_operand_kind(op) == OP_VARIABLE) {
+        if (index < program->param_count) {
+            fprintf(out, "[FP+%u]", 2 + program->param_count - 1 - index);
+        } else {
+            fprintf(out, "[FP-%u]", index - program->param_count + 1);
+        }
+    } else if (program->name && ir_operand_kind(op) == OP_TEMP) {
+        fprintf(out, "[FP-%u]", locals + index + 1);
+    } else {
+        if (ir_operand_kind(op) == OP_CONSTANT) fprintf(out, "#");
+        print_operand(out, program, op);
+    }
+}
 
 // --- Main Code Generation Logic ---
 
-void generate_code(IRInstruction* head) {
-    for (IRInstruction* current = head; current; current = current->next) {
+static void generate_unit(FILE* out, const IRProgram* program) {
+    for (size_t i = 0; i < program->count; i++) {
+        const IRInstruction* current = &program->code[i];
         switch (current->op) {
             case IR_ASSIGN:
-                printf("    MOV R1, ");
-                if (current->arg1.type == OP_CONSTANT) {
-                    printf("#");
-                }
-                print_operand(current->arg1);
-                printf("\n");
-                printf("    MOV ");
-                print_operand(current->result);
-                printf(", R1\n");
+                fprintf(out, "    MOV R1, ");
+                print_location(out, program, current->arg1);
+                fprintf(out, "\n");
+                fprintf(out, "    MOV ");
+                print_location(out, program, current->result);
+                fprintf(out, ", R1\n");
                 break;
 
             case IR_ADD:
@@ -33,39 +56,112 @@ void generate_code(IRInstruction* head) {
                 else if (current->op == IR_MUL) op_str = "MUL";
                 else if (current->op == IR_DIV) op_str = "DIV";
                 
-                printf("    MOV R1, ");
-                if (current->arg1.type == OP_CONSTANT) printf("#");
-                print_operand(current->arg1);
-                printf("\n");
-                printf("    MOV R2, ");
-                if (current->arg2.type == OP_CONSTANT) printf("#");
-                print_operand(current->arg2);
-                printf("\n");
-                printf("    %s R1, R2\n", op_str);
-                printf("    MOV ");
-                print_operand(current->result);
-                printf(", R1\n");
+                fprintf(out, "    MOV R1, ");
+                print_location(out, program, current->arg1);
+                fprintf(out, "\n");
+                fprintf(out, "    MOV R2, ");
+                print_location(out, program, current->arg2);
+                fprintf(out, "\n");
+                fprintf(out, "    %s R1, R2\n", op_str);
+                fprintf(out, "    MOV ");
+                print_location(out, program, current->result);
+                fprintf(out, ", R1\n");
                 break;
             }
             case IR_LABEL:
-                print_operand(current->result);
-                printf(":\n");
+                print_operand(out, program, current->result);
+                fprintf(out, ":\n");
                 break;
             case IR_GOTO:
-                printf("    JMP ");
-                print_operand(current->result);
-                printf("\n");
+                fprintf(out, "    JMP ");
+                print_operand(out, program, current->result);
+                fprintf(out, "\n");
+                break;
+            case IR_IF_EQ:
+            case IR_IF_NE:
+            case IR_IF_LT:
+            case IR_IF_LE:
+            case IR_IF_GT:
+            case IR_IF_GE: {
+                static const char* const jumps[] = { "JE", "JNE", "JL", "JLE", "JG", "JGE" };
+                fprintf(out, "    CMP ");
+                print_location(out, program, current->arg1);
+                fprintf(out, ", ");
+                print_location(out, program, current->arg2);
+                fprintf(out, "\n");
+                fprintf(out, "    %s ", jumps[current->op - IR_IF_EQ]);
+                print_operand(out, program, current->result);
+                fprintf(out, "\n");
+                break;
+            }
+            case IR_PARAM:
+                fprintf(out, "    MOV R1, ");
+                print_location(out, program, current->arg1);
+                fprintf(out, "\n");
+                fprintf(out, "    PUSH R1\n");
+                break;
+            case IR_CALL: {
+                int arg_count = ir_constant_value(program, current->arg2);
+                fprintf(out, "    CALL ");
+                print_operand(out, program, current->arg1);
+                fprintf(out, "\n");
+                if (arg_count) fprintf(out, "    ADD SP, #%d\n", arg_count);
+                if (current->result) {
+                    fprintf(out, "    MOV ");
+                    print_location(out, program, current->result);
+                    fprintf(out, ", R0\n");
+                }
                 break;
-            case IR_IF_GOTO:
-                printf("    CMP ");
-                print_operand(current->arg1);
-                printf(", #0\n");
-                printf("    JNE ");
-                print_operand(current->result);
-                printf("\n");
+            }
+            case IR_RETURN:
+                // Without a value a function returns 0
+                fprintf(out, "    MOV R0, ");
+                if (current->arg1) {
+                    print_location(out, program, current->arg1);
+                } else {
+                    fprintf(out, "#0");
+                }
+                fprintf(out, "\n");
+                fprintf(out, "    MOV SP, FP\n");
+                fprintf(out, "    POP FP\n");
+                fprintf(out, "    RET\n");
                 break;
             default:
                 break;
         }
     }
-} 
\ No newline at end of file
+}
+
+// A function's entry, frame setup and body
+static void generate_function(FILE* out, const IRProgram* unit) {
+    uint32_t frame = (uint32_t)unit->variable_count - unit->param_count + unit->temp_count;
+    fprintf(out, "%s:\n", unit->name);
+    fprintf(out, "    PUSH FP\n");
+    fprintf(out, "    MOV FP, SP\n");
+    if (frame) fprintf(out, "    SUB SP, #%u\n", frame);
+    generate_unit(out, unit);
+}
+
+void generate_code(FILE* out, const IRProgram* program) {
+    // The program's code ends the run; the functions come after it
+    generate_unit(out, program);
+    generate_code_end(out);
+    for (size_t f = 0; f < program->function_count; f++) {
+        generate_function(out, &program->functions[f]);
+    }
+}
+
+void generate_code_statement(FILE* out, const IRProgram* program) {
+    // The code of later statements follows, so each function is jumped over
+    generate_unit(out, program);
+    for (size_t f = 0; f < program->function_count; f++) {
+        const IRProgram* unit = &program->functions[f];
+        fprintf(out, "    JMP %s$end\n", unit->name);
+        generate_function(out, unit);
+        fprintf(out, "%s$end:\n", unit->name);
+    }
+}
+
+void generate_code_end(FILE* out) {
+    fprintf(out, "    HALT\n");
+}
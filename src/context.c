@@ -0,0 +1,26 @@
+#include "context.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void compiler_context_init(CompilerContext* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->scan.line = 1;
+    ctx->scan.names = &ctx->names;
+    ctx->line_num = 1;
+    if (yylex_init_extra(&ctx->scan, &ctx->scanner) != 0) {
+        fprintf(stderr, "Error: cannot create scanner\n");
+        exit(1);
+    }
+    ctx->table = create_symbol_table();
+}
+
+void compiler_context_free(CompilerContext* ctx) {
+    yylex_destroy(ctx->scanner);
+    free_symbol_table(ctx->table);
+    diagnostics_release(&ctx->diagnostics);
+    call_graph_release(&ctx->calls);
+    ast_release(&ctx->ast);
+    intern_reset(&ctx->names);
+    memset(ctx, 0, sizeof(*ctx));
+}
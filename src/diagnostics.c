@@ -0,0 +1,55 @@
+#include "diagnostics.h"
+#include <stdlib.h>
+#include <string.h>
+
+void diagnostics_init(DiagnosticList* list, size_t limit) {
+    memset(list, 0, sizeof(*list));
+    list->limit = limit;
+}
+
+void diagnostics_release(DiagnosticList* list) {
+    arena_release(&list->arena);
+    size_t limit = list->limit;
+    diagnostics_init(list, limit);
+}
+
+void diagnostic_add(DiagnosticList* list, int line_number, const char* message) {
+    if (!list->limit) list->limit = DIAGNOSTIC_LIMIT;
+    if (list->count == list->limit) {
+        list->dropped++;
+        return;
+    }
+    if (!list->items) list->items = arena_alloc(&list->arena, list->limit * sizeof(Diagnostic));
+    list->items[list->count++] =
+        (Diagnostic){ line_number, arena_strndup(&list->arena, message, strlen(message)) };
+}
+
+void diagnostics_append(DiagnosticList* list, const DiagnosticList* from) {
+    for (size_t i = 0; i < from->count; i++) {
+        diagnostic_add(list, from->items[i].line_number, from->items[i].message);
+    }
+    list->dropped += from->dropped;
+}
+
+void diagnostics_sort(DiagnosticList* list, size_t first) {
+    // Insertion sort: the list is short and mostly in order already
+    for (size_t i = first + 1; i < list->count; i++) {
+        Diagnostic d = list->items[i];
+        size_t j = i;
+        while (j > first && list->items[j - 1].line_number > d.line_number) {
+            list->items[j] = list->items[j - 1];
+            j--;
+        }
+        list->items[j] = d;
+    }
+}
+
+void diagnostics_print(FILE* out, const DiagnosticList* list, size_t* printed) {
+    for (; *printed < list->count; ++*printed) {
+        fprintf(out, "%s\n", list->items[*printed].message);
+    }
+}
+
+size_t diagnostics_total(const DiagnosticList* list) {
+    return list->count + list->dropped;
+}
@@ -0,0 +1,128 @@
+#include "intern.h"
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Each string is stored right after a small header in the string arena, which
+// lets intern_id() recover the id from the pointer alone.
+typedef struct {
+    InternId id;
+    uint32_t length;
+} InternHeader;
+
+static void* xmalloc(size_t size) {
+    void* p = malloc(size);
+    if (!p) {
+        fprintf(stderr, "Error: out of memory in string interner\n");
+        exit(1);
+    }
+    return p;
+}
+
+uint32_t intern_hash(const char* text, size_t len) {
+    uint32_t h = 2166136261u;  // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)text[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static char* store_text(Interner* names, const char* text, size_t len, InternId id) {
+    InternHeader* header = arena_alloc(&names->strings, sizeof(InternHeader) + len + 1);
+    header->id = id;
+    header->length = (uint32_t)len;
+    char* copy = (char*)(header + 1);
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+static void grow_table(Interner* names) {
+    size_t new_count = names->slot_count ? names->slot_count * 2 : 1024;
+    uint32_t* new_slots = calloc(new_count, sizeof(uint32_t));
+    uint32_t* new_hashes = xmalloc(new_count * sizeof(uint32_t));
+    if (!new_slots) {
+        fprintf(stderr, "Error: out of memory in string interner\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < names->slot_count; i++) {
+        if (!names->slots[i]) continue;
+        size_t j = names->slot_hashes[i] & (new_count - 1);
+        while (new_slots[j]) j = (j + 1) & (new_count - 1);
+        new_slots[j] = names->slots[i];
+        new_hashes[j] = names->slot_hashes[i];
+    }
+    free(names->slots);
+    free(names->slot_hashes);
+    names->slots = new_slots;
+    names->slot_hashes = new_hashes;
+    names->slot_count = new_count;
+}
+
+const char* intern_n(Interner* names, const char* text, size_t len) {
+    return intern_hashed(names, text, len, intern_hash(text, len));
+}
+
+const char* intern_hashed(Interner* names, const char* text, size_t len, uint32_t h) {
+    // Keep the load factor under one half
+    if ((names->name_count + 1) * 2 > names->slot_count) grow_table(names);
+
+    size_t mask = names->slot_count - 1;
+    size_t i = h & mask;
+    while (names->slots[i]) {
+        if (names->slot_hashes[i] == h) {
+            const char* candidate = names->names[names->slots[i] - 1];
+            const InternHeader* header = (const InternHeader*)candidate - 1;
+            if (header->length == len && memcmp(candidate, text, len) == 0) {
+                return candidate;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+
+    if (names->name_count == names->name_capacity) {
+        names->name_capacity = names->name_capacity ? names->name_capacity * 2 : 1024;
+        const char** grown = realloc(names->names, names->name_capacity * sizeof(const char*));
+        if (!grown) {
+            fprintf(stderr, "Error: out of memory in string interner\n");
+            exit(1);
+        }
+        names->names = grown;
+    }
+    InternId id = (InternId)names->name_count;
+    const char* copy = store_text(names, text, len, id);
+    names->names[names->name_count++] = copy;
+    names->slots[i] = id + 1;
+    names->slot_hashes[i] = h;
+    return copy;
+}
+
+const char* intern(Interner* names, const char* text) {
+    return intern_n(names, text, strlen(text));
+}
+
+InternId intern_id(const char* canonical) {
+    return ((const InternHeader*)canonical - 1)->id;
+}
+
+const char* intern_name(const Interner* names, InternId id) {
+    return id < names->name_count ? names->names[id] : NULL;
+}
+
+size_t intern_count(const Interner* names) {
+    return names->name_count;
+}
+
+size_t intern_bytes_used(const Interner* names) {
+    return names->strings.used;
+}
+
+void intern_reset(Interner* names) {
+    arena_release(&names->strings);
+    free(names->slots);
+    free(names->slot_hashes);
+    free(names->names);
+    memset(names, 0, sizeof(*names));
+}
@@ -1,284 +1,861 @@
 #include "ir.h"
 #include "ast.h"
+#include "context.h"
+#include "intern.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 
-// --- Globals for IR Generation ---
-static int temp_count = 0;
-static int label_count = 0;
-
-// Simple hash for binary expressions
-#define MAX_EXPR_CACHE 128
-static struct {
-    IROp op;
-    char left[32];
-    char right[32];
-    char temp[16];
-    bool used;
-} expr_cache[MAX_EXPR_CACHE];
-static int expr_cache_count = 0;
-
 // --- Helper Functions ---
-char* new_temp() {
-    char* temp = malloc(16);
-    sprintf(temp, "t%d", temp_count++);
-    return temp;
+static void* grow_array(void* items, size_t* capacity, size_t elem_size, size_t initial) {
+    *capacity = *capacity ? *capacity * 2 : initial;
+    void* grown = realloc(items, *capacity * elem_size);
+    if (!grown) {
+        fprintf(stderr, "Error: out of memory in IR generation\n");
+        exit(1);
+    }
+    return grown;
 }
 
-char* new_label() {
-    char* label = malloc(16);
-    sprintf(label, "L%d", label_count++);
-    return label;
+// Temps and labels are plain numbers, printed as t<n> and L<n>
+static IROperand new_temp(CompilerContext* ctx) {
+    return ir_operand(OP_TEMP, (uint32_t)ctx->ir.temp_count++);
 }
 
-// Deep copy for IROperand
-IROperand deep_copy_operand(const IROperand* src) {
-    IROperand dest = *src;
-    if ((src->type == OP_VARIABLE || src->type == OP_TEMP || src->type == OP_LABEL) && src->name) {
-        dest.name = strdup(src->name);
-    }
-    return dest;
+static IROperand new_label(CompilerContext* ctx) {
+    return ir_operand(OP_LABEL, (uint32_t)ctx->ir.label_count++);
 }
 
-IRInstruction* create_ir_instruction(IROp op, int line_number) {
-    IRInstruction* instr = (IRInstruction*)calloc(1, sizeof(IRInstruction));
+IRInstruction* ir_append(IRProgram* program, IROp op, int line_number) {
+    if (program->count == program->capacity) {
+        program->code = grow_array(program->code, &program->capacity, sizeof(IRInstruction), 256);
+    }
+    IRInstruction* instr = &program->code[program->count++];
+    memset(instr, 0, sizeof(*instr));
     instr->op = op;
-    instr->line_number = line_number;
+    instr->line_number = (uint32_t)line_number < IR_MAX_LINE ? (uint32_t)line_number : IR_MAX_LINE;
     return instr;
 }
 
-IRInstruction* append_ir(IRInstruction* a, IRInstruction* b) {
-    if (!a) return b;
-    if (!b) return a;
-    IRInstruction* current = a;
-    while (current->next) {
-        current = current->next;
+static uint32_t constant_hash(int value) {
+    return (uint32_t)value * 0x9E3779B1u;
+}
+
+IROperand ir_add_constant(IRProgram* program, int value) {
+    if ((program->constant_count + 1) * 2 > program->constant_slot_count) {
+        size_t count = program->constant_slot_count ? program->constant_slot_count * 2 : 256;
+        uint32_t* slots = calloc(count, sizeof(uint32_t));
+        if (!slots) {
+            fprintf(stderr, "Error: out of memory in IR generation\n");
+            exit(1);
+        }
+        for (size_t i = 0; i < program->constant_count; i++) {
+            size_t at = constant_hash(program->constants[i]) & (count - 1);
+            while (slots[at]) at = (at + 1) & (count - 1);
+            slots[at] = (uint32_t)i + 1;
+        }
+        free(program->constant_slots);
+        program->constant_slots = slots;
+        program->constant_slot_count = count;
     }
-    current->next = b;
-    return a;
+
+    size_t mask = program->constant_slot_count - 1;
+    size_t at = constant_hash(value) & mask;
+    while (program->constant_slots[at]) {
+        uint32_t index = program->constant_slots[at] - 1;
+        if (program->constants[index] == value) return ir_operand(OP_CONSTANT, index);
+        at = (at + 1) & mask;
+    }
+    if (program->constant_count == program->constant_capacity) {
+        program->constants = grow_array(program->constants, &program->constant_capacity,
+                                        sizeof(int), 64);
+    }
+    program->constants[program->constant_count] = value;
+    program->constant_slots[at] = (uint32_t)++program->constant_count;
+    return ir_operand(OP_CONSTANT, (uint32_t)program->constant_count - 1);
+}
+
+IROperand ir_add_variable(IRProgram* program, const char* name) {
+    if (program->variable_count == program->variable_capacity) {
+        program->variables = grow_array(program->variables, &program->variable_capacity,
+                                        sizeof(const char*), 64);
+    }
+    program->variables[program->variable_count] = name;
+    return ir_operand(OP_VARIABLE, (uint32_t)program->variable_count++);
 }
 
-// --- Forward Declarations for Recursive Generation ---
-IRInstruction* generate_ir_for_expression(ASTNode* node, IROperand* result_operand);
+IROperand ir_add_callee(IRProgram* program, const char* name) {
+    if (program->callee_count == program->callee_capacity) {
+        program->callees = grow_array(program->callees, &program->callee_capacity,
+                                      sizeof(const char*), 16);
+    }
+    program->callees[program->callee_count] = name;
+    return ir_operand(OP_FUNCTION, (uint32_t)program->callee_count++);
+}
+
+static IRProgram* add_function(IRProgram* program, const char* name) {
+    if (program->function_count == program->function_capacity) {
+        program->functions = grow_array(program->functions, &program->function_capacity,
+                                        sizeof(IRProgram), 16);
+    }
+    IRProgram* unit = &program->functions[program->function_count++];
+    memset(unit, 0, sizeof(*unit));
+    unit->name = name;
+    return unit;
+}
+
+bool ir_program_empty(const IRProgram* program) {
+    return !program->count && !program->function_count;
+}
+
+void ir_program_free(IRProgram* program) {
+    // Names are interned, so only the arrays are owned
+    for (size_t i = 0; i < program->function_count; i++) ir_program_free(&program->functions[i]);
+    free(program->functions);
+    free(program->code);
+    free(program->constants);
+    free(program->constant_slots);
+    free(program->variables);
+    free(program->callees);
+    free(program->loops);
+    memset(program, 0, sizeof(*program));
+}
 
 // --- Main IR Generation Logic ---
-IRInstruction* generate_ir_for_statement(ASTNode* node) {
-    if (!node) return NULL;
+// Statements and expressions are walked with explicit stacks instead of
+// recursion, so stack use does not grow with the length of the program, and
+// each instruction is appended to the program as it is produced.
+typedef struct {
+    NodeId node;
+    bool combine;   // operands of this binary node or call are on the value stack
+    int line;       // of the innermost node around it that is not shared
+} ExprItem;
+
+typedef struct {
+    NodeId node;
+    IROperand label;       // when set: emit op to this label instead of visiting node
+    IROp op;               // IR_LABEL or IR_GOTO
+    int line_number;       // of the label or jump
+} StmtItem;
+
+// Function declarations met while generating, to be compiled as units of
+// their own once the current unit is done
+typedef struct {
+    NodeId decl;
+    const char* name;       // qualified name of the unit
+} QueuedFunction;
+
+typedef struct {
+    QueuedFunction* items;
+    size_t count;
+    size_t capacity;
+} FunctionQueue;
+
+// A test in a chain of branches: jump to label when node's value is sense.
+// With no node, the label is placed instead.
+typedef struct {
+    NodeId node;
+    IROperand label;
+    bool sense;
+} BranchItem;
+
+typedef struct {
+    CompilerContext* ctx;
+    IRProgram* program;
+    FunctionQueue* queue;
+    ExprItem* exprs;
+    size_t expr_count, expr_capacity;
+    IROperand* values;
+    size_t value_count, value_capacity;
+    StmtItem* stmts;
+    size_t stmt_count, stmt_capacity;
+    BranchItem* branches;
+    size_t branch_count, branch_capacity;
+
+    // Each variable gets one operand per program, as constants do (see
+    // ir_add_constant())
+    IROperand* variable_of;     // by intern id of the name; 0 until first use
+    size_t variable_of_count;
+    IROperand* callee_of;       // by intern id of the callee's own name
+    size_t callee_of_count;
+} IRGen;
+
+static void push_expr(IRGen* gen, NodeId node, bool combine, int line) {
+    if (gen->expr_count == gen->expr_capacity) {
+        gen->exprs = grow_array(gen->exprs, &gen->expr_capacity, sizeof(ExprItem), 64);
+    }
+    gen->exprs[gen->expr_count++] = (ExprItem){ node, combine, line };
+}
+
+static void push_value(IRGen* gen, IROperand value) {
+    if (gen->value_count == gen->value_capacity) {
+        gen->values = grow_array(gen->values, &gen->value_capacity, sizeof(IROperand), 64);
+    }
+    gen->values[gen->value_count++] = value;
+}
+
+static void push_stmt(IRGen* gen, NodeId node) {
+    if (gen->stmt_count == gen->stmt_capacity) {
+        gen->stmts = grow_array(gen->stmts, &gen->stmt_capacity, sizeof(StmtItem), 64);
+    }
+    gen->stmts[gen->stmt_count++] = (StmtItem){ node, IR_NO_OPERAND, IR_LABEL, 0 };
+}
+
+static void push_jump(IRGen* gen, IROp op, IROperand label, int line_number) {
+    push_stmt(gen, AST_NONE);
+    gen->stmts[gen->stmt_count - 1].label = label;
+    gen->stmts[gen->stmt_count - 1].op = op;
+    gen->stmts[gen->stmt_count - 1].line_number = line_number;
+}
+
+static void push_branch(IRGen* gen, NodeId node, IROperand label, bool sense) {
+    if (gen->branch_count == gen->branch_capacity) {
+        gen->branches = grow_array(gen->branches, &gen->branch_capacity, sizeof(BranchItem), 64);
+    }
+    gen->branches[gen->branch_count++] = (BranchItem){ node, label, sense };
+}
+
+static IRInstruction* emit(IRGen* gen, IROp op, int line_number) {
+    return ir_append(gen->program, op, line_number);
+}
+
+static void emit_label(IRGen* gen, IROperand label, int line_number) {
+    emit(gen, IR_LABEL, line_number)->result = label;
+}
+
+
+static const char* qualified_name(IRGen* gen, const char* name) {
+    const char* outer = gen->program->name;
+    if (!outer) return name;
+    size_t outer_len = strlen(outer), len = strlen(name);
+    char* joined = malloc(outer_len + len + 2);
+    if (!joined) {
+        fprintf(stderr, "Error: out of memory in IR generation\n");
+        exit(1);
+    }
+    memcpy(joined, outer, outer_len);
+    joined[outer_len] = '.';
+    memcpy(joined + outer_len + 1, name, len);
+    const char* interned = intern_n(&gen->ctx->names, joined, outer_len + len + 1);
+    free(joined);
+    return interned;
+}
+
+static void queue_function(IRGen* gen, NodeId decl) {
+    FunctionQueue* queue = gen->queue;
+    if (queue->count == queue->capacity) {
+        queue->items = grow_array(queue->items, &queue->capacity, sizeof(QueuedFunction), 16);
+    }
+    const char* name = qualified_name(gen, ast_node(&gen->ctx->ast, decl)->func_decl.name);
+    queue->items[queue->count++] = (QueuedFunction){ decl, name };
+}
+
+// The entry for a name in a table indexed by intern id, grown as needed
+static IROperand* name_slot(IRGen* gen, IROperand** table, size_t* table_count, const char* name) {
+    InternId id = intern_id(name);
+    if (id >= *table_count) {
+        size_t count = intern_count(&gen->ctx->names);
+        if (count <= id) count = (size_t)id + 1;
+        IROperand* grown = realloc(*table, count * sizeof(IROperand));
+        if (!grown) {
+            fprintf(stderr, "Error: out of memory in IR generation\n");
+            exit(1);
+        }
+        memset(grown + *table_count, 0, (count - *table_count) * sizeof(IROperand));
+        *table = grown;
+        *table_count = count;
+    }
+    return &(*table)[id];
+}
+
+static IROperand variable_operand(IRGen* gen, const char* name) {
+    IROperand* slot = name_slot(gen, &gen->variable_of, &gen->variable_of_count, name);
+    if (!*slot) *slot = ir_add_variable(gen->program, name);
+    return *slot;
+}
+
+// A function can only call the functions declared in its own body, and the
+// program the ones declared at its top level, so the callee's unit is named
+// after the caller's.
+static IROperand callee_operand(IRGen* gen, const char* name) {
+    IROperand* slot = name_slot(gen, &gen->callee_of, &gen->callee_of_count, name);
+    if (!*slot) *slot = ir_add_callee(gen->program, qualified_name(gen, name));
+    return *slot;
+}
+
+static IROperand find_expr_cache(const IRGenState* state, IROp op, IROperand left, IROperand right) {
+    for (int i = 0; i < state->expr_cache_count; ++i) {
+        const IRExprCacheEntry* entry = &state->expr_cache[i];
+        if (entry->op == op && entry->left == left && entry->right == right) {
+            return entry->temp;
+        }
+    }
+    return IR_NO_OPERAND;
+}
 
-    switch (node->type) {
-        case AST_VAR_DECL:
-        case AST_ASSIGNMENT: {
-            IROperand rhs_operand;
-            IRInstruction* expr_code = generate_ir_for_expression(node->var_decl.value, &rhs_operand);
+static void add_expr_cache(IRGenState* state, IROp op, IROperand left, IROperand right, IROperand temp) {
+    if (state->expr_cache_count < IR_EXPR_CACHE_SIZE) {
+        IRExprCacheEntry* entry = &state->expr_cache[state->expr_cache_count++];
+        entry->op = op;
+        entry->left = left;
+        entry->right = right;
+        entry->temp = temp;
+    }
+}
 
-            IRInstruction* assign_code = create_ir_instruction(IR_ASSIGN, node->line_number);
-            assign_code->result.type = OP_VARIABLE;
-            assign_code->result.name = strdup(node->type == AST_VAR_DECL ? node->var_decl.name : node->assignment.name);
-            assign_code->arg1 = rhs_operand;
+static bool is_comparison(ASTOperator op) {
+    return op == AST_OP_LT || op == AST_OP_LEQ || op == AST_OP_GT || op == AST_OP_GEQ ||
+           op == AST_OP_EQ || op == AST_OP_NEQ;
+}
+
+// Comparisons and logical operators: their value is a truth value, and they
+// are lowered to branches
+static bool is_condition(const ASTNode* node) {
+    if (node->type == AST_UNARY_OP) return node->unary.op == AST_OP_NOT;
+    return node->type == AST_BINARY_OP &&
+           (is_comparison(node->binary.op) || node->binary.op == AST_OP_AND || node->binary.op == AST_OP_OR);
+}
 
-            return append_ir(expr_code, assign_code);
+static IROp branch_op(ASTOperator op) {
+    switch (op) {
+        case AST_OP_EQ: return IR_IF_EQ;
+        case AST_OP_NEQ: return IR_IF_NE;
+        case AST_OP_LT: return IR_IF_LT;
+        case AST_OP_LEQ: return IR_IF_LE;
+        case AST_OP_GT: return IR_IF_GT;
+        default: return IR_IF_GE;
+    }
+}
+
+// The branch taken exactly when op's is not
+static IROp negate_branch(IROp op) {
+    switch (op) {
+        case IR_IF_EQ: return IR_IF_NE;
+        case IR_IF_NE: return IR_IF_EQ;
+        case IR_IF_LT: return IR_IF_GE;
+        case IR_IF_LE: return IR_IF_GT;
+        case IR_IF_GT: return IR_IF_LE;
+        default: return IR_IF_LT;
+    }
+}
+
+static IROperand generate_ir_for_expression(IRGen* gen, NodeId root, int line_number);
+static IROperand generate_condition_value(IRGen* gen, NodeId id, int line_number);
+
+// Emit code that jumps to label when the condition at root is `sense` and
+// falls through otherwise. A comparison becomes one compare-and-branch, and
+// any other value is compared with 0. && and || short-circuit into chains of
+// branches: the right operand is only evaluated when the left one leaves the
+// outcome open. Everything emitted is given line_number, the line of the
+// statement or expression around the condition.
+static void generate_branch(IRGen* gen, NodeId root, IROperand label, bool sense, int line_number) {
+    size_t base = gen->branch_count;
+    push_branch(gen, root, label, sense);
+    while (gen->branch_count > base) {
+        BranchItem item = gen->branches[--gen->branch_count];
+        if (!item.node) {
+            emit_label(gen, item.label, line_number);
+            continue;
+        }
+        const ASTNode* node = ast_node(&gen->ctx->ast, item.node);
+        if (node->type == AST_UNARY_OP && node->unary.op == AST_OP_NOT) {
+            push_branch(gen, node->unary.operand, item.label, !item.sense);
+            continue;
         }
-        case AST_IF: {
-            IROperand condition_operand;
-            IRInstruction* cond_code = generate_ir_for_expression(node->if_stmt.condition, &condition_operand);
-
-            char* true_label_name = new_label();
-            char* end_label_name = new_label();
-
-            IRInstruction* if_goto_code = create_ir_instruction(IR_IF_GOTO, node->line_number);
-            if_goto_code->arg1 = condition_operand;
-            if_goto_code->result.type = OP_LABEL;
-            if_goto_code->result.name = true_label_name;
-            
-            IRInstruction* then_code = generate_ir_for_statement(node->if_stmt.then_branch);
-            
-            IRInstruction* true_label_code = create_ir_instruction(IR_LABEL, node->line_number);
-            true_label_code->result.type = OP_LABEL;
-            true_label_code->result.name = strdup(true_label_name);
-            
-            IRInstruction* end_label_code = create_ir_instruction(IR_LABEL, node->line_number);
-            end_label_code->result.type = OP_LABEL;
-            end_label_code->result.name = end_label_name;
-
-            IRInstruction* final_code = cond_code;
-            final_code = append_ir(final_code, if_goto_code);
-            final_code = append_ir(final_code, true_label_code);
-            final_code = append_ir(final_code, then_code);
-            final_code = append_ir(final_code, end_label_code);
-            
-            return final_code;
+        if (node->type == AST_BINARY_OP && (node->binary.op == AST_OP_AND || node->binary.op == AST_OP_OR)) {
+            // a && b is true when both are, a || b when either is. When the
+            // outcome sought needs both operands to agree, a left operand
+            // that does not skips the right one.
+            bool both = node->binary.op == AST_OP_AND;
+            if (both == item.sense) {
+                IROperand skip = new_label(gen->ctx);
+                push_branch(gen, AST_NONE, skip, false);
+                push_branch(gen, node->binary.right, item.label, item.sense);
+                push_branch(gen, node->binary.left, skip, !item.sense);
+            } else {
+                push_branch(gen, node->binary.right, item.label, item.sense);
+                push_branch(gen, node->binary.left, item.label, item.sense);
+            }
+            continue;
         }
-        case AST_STATEMENT_LIST: {
-            IRInstruction* stmt_code = generate_ir_for_statement(node->stmt_list.stmt);
-            IRInstruction* next_code = generate_ir_for_statement(node->stmt_list.next);
-            return append_ir(stmt_code, next_code);
+
+        // A single test. The memo may hold temps of a test that was skipped.
+        gen->ctx->ir.expr_cache_count = 0;
+        IROp op = IR_IF_NE;
+        IROperand left, right;
+        if (node->type == AST_BINARY_OP && is_comparison(node->binary.op)) {
+            op = branch_op(node->binary.op);
+            NodeId right_node = node->binary.right;
+            left = generate_ir_for_expression(gen, node->binary.left, line_number);
+            right = generate_ir_for_expression(gen, right_node, line_number);
+        } else {
+            left = generate_ir_for_expression(gen, item.node, line_number);
+            right = ir_add_constant(gen->program, 0);
         }
-        default:
-            // Handle other statements like function calls if they can be standalone
-            return NULL;
+        IRInstruction* code = emit(gen, item.sense ? op : negate_branch(op), line_number);
+        code->arg1 = left;
+        code->arg2 = right;
+        code->result = item.label;
     }
 }
 
-static const char* find_expr_cache(IROp op, const char* left, const char* right) {
-    for (int i = 0; i < expr_cache_count; ++i) {
-        if (expr_cache[i].used && expr_cache[i].op == op &&
-            strcmp(expr_cache[i].left, left) == 0 && strcmp(expr_cache[i].right, right) == 0) {
-            return expr_cache[i].temp;
+// Emit the code for an expression and return the operand holding its value.
+// Numbers and variables are used in place as constant and variable operands;
+// every computed value lands in a new temporary, which keeps the IR true TAC.
+// An expression that produces no code yields an empty operand. Conditions
+// nested in an expression call back into here for their operands, so the
+// stacks are only used above the entries already on them.
+//
+// Shared nodes (see ast_is_shared()) keep the line of their first use, so
+// their code gets the line of the innermost node around them that is not
+// shared, starting from line_number, the line of the expression's statement.
+static IROperand generate_ir_for_expression(IRGen* gen, NodeId root, int line_number) {
+    size_t base = gen->expr_count;
+    push_expr(gen, root, false, line_number);
+    while (gen->expr_count > base) {
+        ExprItem item = gen->exprs[--gen->expr_count];
+        if (!item.node) {
+            push_value(gen, IR_NO_OPERAND);
+            continue;
         }
+        const ASTNode* node = ast_node(&gen->ctx->ast, item.node);
+        int line = ast_is_shared((ASTNodeType)node->type) ? item.line : node->line_number;
+        IROperand result = IR_NO_OPERAND;
+
+        switch (node->type) {
+            case AST_NUMBER:
+                result = ir_add_constant(gen->program, node->number.value);
+                break;
+            case AST_IDENTIFIER:
+                result = variable_operand(gen, node->identifier.name);
+                break;
+            case AST_UNARY_OP:
+                if (is_condition(node)) result = generate_condition_value(gen, item.node, line);
+                break;
+            case AST_BINARY_OP: {
+                if (is_condition(node)) {
+                    result = generate_condition_value(gen, item.node, line);
+                    break;
+                }
+                if (!item.combine) {
+                    // Left operand first: it is pushed last
+                    push_expr(gen, item.node, true, item.line);
+                    push_expr(gen, node->binary.right, false, line);
+                    push_expr(gen, node->binary.left, false, line);
+                    continue;
+                }
+                IROperand op2 = gen->values[--gen->value_count];
+                IROperand op1 = gen->values[--gen->value_count];
+
+                IROp op_type;
+                switch (node->binary.op) {
+                    case AST_OP_ADD: op_type = IR_ADD; break;
+                    case AST_OP_SUB: op_type = IR_SUB; break;
+                    case AST_OP_MUL: op_type = IR_MUL; break;
+                    default: op_type = IR_DIV; break;
+                }
+
+                // Memoization: check if this expression was already computed
+                IROperand cached = find_expr_cache(&gen->ctx->ir, op_type, op1, op2);
+                if (cached) {
+                    result = cached; // No new instruction needed
+                    break;
+                }
+                result = new_temp(gen->ctx);
+                add_expr_cache(&gen->ctx->ir, op_type, op1, op2, result);
+
+                IRInstruction* code = emit(gen, op_type, line);
+                code->result = result;
+                code->arg1 = op1;
+                code->arg2 = op2;
+                break;
+            }
+            case AST_FUNCTION_CALL: {
+                NodeId args = node->func_call.args;
+                if (!item.combine) {
+                    // The argument list runs from the last argument back, so
+                    // pushing it in list order evaluates the first one first
+                    push_expr(gen, item.node, true, item.line);
+                    for (NodeId arg = args; arg; arg = ast_node(&gen->ctx->ast, arg)->expr_list.next) {
+                        push_expr(gen, ast_node(&gen->ctx->ast, arg)->expr_list.expr, false, line);
+                    }
+                    continue;
+                }
+                uint32_t count = 0;
+                for (NodeId arg = args; arg; arg = ast_node(&gen->ctx->ast, arg)->expr_list.next) count++;
+                gen->value_count -= count;
+                for (uint32_t i = 0; i < count; i++) {
+                    emit(gen, IR_PARAM, line)->arg1 = gen->values[gen->value_count + i];
+                }
+                result = new_temp(gen->ctx);
+                IRInstruction* call = emit(gen, IR_CALL, line);
+                call->result = result;
+                call->arg1 = callee_operand(gen, node->func_call.name);
+                call->arg2 = ir_add_constant(gen->program, (int)count);
+                break;
+            }
+            default:
+                break;
+        }
+        push_value(gen, result);
+    }
+    return gen->values[--gen->value_count];
+}
+
+// The value of a condition as 1 or 0
+static IROperand generate_condition_value(IRGen* gen, NodeId id, int line_number) {
+    IROperand result = new_temp(gen->ctx);
+    IROperand done = new_label(gen->ctx);
+    IRInstruction* set = emit(gen, IR_ASSIGN, line_number);
+    set->result = result;
+    set->arg1 = ir_add_constant(gen->program, 1);
+    generate_branch(gen, id, done, true, line_number);
+    set = emit(gen, IR_ASSIGN, line_number);
+    set->result = result;
+    set->arg1 = ir_add_constant(gen->program, 0);
+    emit_label(gen, done, line_number);
+    // Temps computed in the branches may not have been on the way here
+    gen->ctx->ir.expr_cache_count = 0;
+    return result;
+}
+
+// Emit `name = value` for a declaration or assignment and return the operand
+// assigned.
+static IROperand generate_ir_for_assignment(IRGen* gen, const ASTNode* node) {
+    NodeId value = node->type == AST_VAR_DECL ? node->var_decl.value : node->assignment.value;
+    IROperand rhs_operand = generate_ir_for_expression(gen, value, node->line_number);
+
+    IROperand target = variable_operand(gen, node->type == AST_VAR_DECL ? node->var_decl.name : node->assignment.name);
+    IRInstruction* assign_code = emit(gen, IR_ASSIGN, node->line_number);
+    assign_code->result = target;
+    assign_code->arg1 = rhs_operand;
+    return rhs_operand;
+}
+
+static IRLoop* add_loop(IRProgram* program) {
+    if (program->loop_count == program->loop_capacity) {
+        program->loops = grow_array(program->loops, &program->loop_capacity, sizeof(IRLoop), 16);
     }
-    return NULL;
+    IRLoop* loop = &program->loops[program->loop_count++];
+    memset(loop, 0, sizeof(*loop));
+    return loop;
 }
 
-static void add_expr_cache(IROp op, const char* left, const char* right, const char* temp) {
-    if (expr_cache_count < MAX_EXPR_CACHE) {
-        expr_cache[expr_cache_count].op = op;
-        strncpy(expr_cache[expr_cache_count].left, left, 31);
-        strncpy(expr_cache[expr_cache_count].right, right, 31);
-        strncpy(expr_cache[expr_cache_count].temp, temp, 15);
-        expr_cache[expr_cache_count].used = true;
-        expr_cache_count++;
+// The operand a number or variable stands for, without emitting anything
+static IROperand leaf_operand(IRGen* gen, NodeId id) {
+    const ASTNode* node = ast_node(&gen->ctx->ast, id);
+    if (node->type == AST_NUMBER) return ir_add_constant(gen->program, node->number.value);
+    if (node->type == AST_IDENTIFIER) return variable_operand(gen, node->identifier.name);
+    return IR_NO_OPERAND;
+}
+
+// `a op b` as `b op' a`
+static ASTOperator mirror_comparison(ASTOperator op) {
+    switch (op) {
+        case AST_OP_LT: return AST_OP_GT;
+        case AST_OP_LEQ: return AST_OP_GEQ;
+        case AST_OP_GT: return AST_OP_LT;
+        case AST_OP_GEQ: return AST_OP_LEQ;
+        default: return op;
     }
 }
 
-IRInstruction* generate_ir_for_expression(ASTNode* node, IROperand* result_operand) {
-    if (!node) return NULL;
+// Find the induction variable of a for-loop: the post statement must be
+// `v = v + c`, `v = c + v` or `v = v - c`, and the condition must compare v.
+// start is what the init statement assigned.
+static void describe_loop(IRGen* gen, IRLoop* loop, const ASTNode* node, IROperand start) {
+    const AST* ast = &gen->ctx->ast;
+    if (!node->for_loop.post || !node->for_loop.cond) return;
+    const ASTNode* post = ast_node(ast, node->for_loop.post);
+    const ASTNode* step = ast_node(ast, post->assignment.value);
+    if (step->type != AST_BINARY_OP || (step->binary.op != AST_OP_ADD && step->binary.op != AST_OP_SUB)) return;
+    const ASTNode* left = ast_node(ast, step->binary.left);
+    const ASTNode* right = ast_node(ast, step->binary.right);
+    const char* name = post->assignment.name;
+    int amount;
+    if (left->type == AST_IDENTIFIER && left->identifier.name == name && right->type == AST_NUMBER) {
+        amount = step->binary.op == AST_OP_ADD ? right->number.value : -right->number.value;
+    } else if (step->binary.op == AST_OP_ADD && right->type == AST_IDENTIFIER &&
+               right->identifier.name == name && left->type == AST_NUMBER) {
+        amount = left->number.value;
+    } else {
+        return;
+    }
 
-    // The result of ANY expression goes into a new temporary. This ensures true TAC.
-    // result_operand->type = OP_TEMP;
-    // result_operand->name = new_temp();
+    const ASTNode* cond = ast_node(ast, node->for_loop.cond);
+    if (cond->type != AST_BINARY_OP || !is_comparison(cond->binary.op)) return;
+    const ASTNode* cond_left = ast_node(ast, cond->binary.left);
+    const ASTNode* cond_right = ast_node(ast, cond->binary.right);
+    if (cond_left->type == AST_IDENTIFIER && cond_left->identifier.name == name) {
+        loop->compare = cond->binary.op;
+        loop->bound = leaf_operand(gen, cond->binary.right);
+    } else if (cond_right->type == AST_IDENTIFIER && cond_right->identifier.name == name) {
+        loop->compare = mirror_comparison(cond->binary.op);
+        loop->bound = leaf_operand(gen, cond->binary.left);
+    } else {
+        return;
+    }
 
-    switch(node->type) {
-        case AST_NUMBER: {
-            result_operand->type = OP_TEMP;
-            result_operand->name = new_temp();
-            IRInstruction* code = create_ir_instruction(IR_ASSIGN, node->line_number);
-            code->result = *result_operand;
-            code->arg1.type = OP_CONSTANT;
-            code->arg1.constant = node->number.value;
-            return code; 
-        }
-        case AST_IDENTIFIER: {
-            result_operand->type = OP_TEMP;
-            result_operand->name = new_temp();
-            IRInstruction* code = create_ir_instruction(IR_ASSIGN, node->line_number);
-            code->result = *result_operand;
-            code->arg1.type = OP_VARIABLE;
-            code->arg1.name = strdup(node->identifier.name);
-            return code;
+    loop->induction = variable_operand(gen, name);
+    loop->step = amount;
+    const ASTNode* init = node->for_loop.init ? ast_node(ast, node->for_loop.init) : NULL;
+    if (init && (init->type == AST_VAR_DECL ? init->var_decl.name : init->assignment.name) == name) {
+        loop->start = start;
+    }
+}
+
+static void generate_ir_for_statements(IRGen* gen, NodeId root) {
+    push_stmt(gen, root);
+    while (gen->stmt_count) {
+        StmtItem item = gen->stmts[--gen->stmt_count];
+        if (item.label) {
+            emit(gen, item.op, item.line_number)->result = item.label;
+            continue;
         }
-        case AST_BINARY_OP: {
-            IROperand op1, op2;
-            IRInstruction* code1 = generate_ir_for_expression(node->binary.left, &op1);
-            IRInstruction* code2 = generate_ir_for_expression(node->binary.right, &op2);
-
-            char* op_str = (char*)node->binary.op;
-            IROp op_type = IR_ASSIGN;
-            if (strcmp(op_str, "+") == 0) op_type = IR_ADD;
-            else if (strcmp(op_str, "-") == 0) op_type = IR_SUB;
-            else if (strcmp(op_str, "*") == 0) op_type = IR_MUL;
-            else if (strcmp(op_str, "/") == 0) op_type = IR_DIV;
-
-            // Memoization: check if this expression was already computed
-            const char* cached = find_expr_cache(op_type, op1.name, op2.name);
-            if (cached) {
-                result_operand->type = OP_TEMP;
-                result_operand->name = strdup(cached);
-                return append_ir(code1, code2); // No new instruction needed
+        if (!item.node) continue;
+        const ASTNode* node = ast_node(&gen->ctx->ast, item.node);
+        // Operands are variables, which the previous statement may have
+        // assigned, and a temp set in a branch may never have been computed,
+        // so the memo only holds within one statement.
+        if (node->type != AST_STATEMENT_LIST) gen->ctx->ir.expr_cache_count = 0;
+
+        switch (node->type) {
+            case AST_VAR_DECL:
+            case AST_ASSIGNMENT:
+                generate_ir_for_assignment(gen, node);
+                break;
+            case AST_IF: {
+                // if not cond goto else; then; goto end; else: else; end:
+                IROperand end_label = new_label(gen->ctx);
+                IROperand else_label = node->if_stmt.else_branch ? new_label(gen->ctx) : end_label;
+                generate_branch(gen, node->if_stmt.condition, else_label, false, node->line_number);
+
+                push_jump(gen, IR_LABEL, end_label, node->line_number);
+                if (node->if_stmt.else_branch) {
+                    push_stmt(gen, node->if_stmt.else_branch);
+                    push_jump(gen, IR_LABEL, else_label, node->line_number);
+                    push_jump(gen, IR_GOTO, end_label, node->line_number);
+                }
+                push_stmt(gen, node->if_stmt.then_branch);
+                break;
             }
+            case AST_FOR: {
+                IRLoop* loop = add_loop(gen->program);
+                loop->header = new_label(gen->ctx);
+                loop->body = new_label(gen->ctx);
+                loop->latch = new_label(gen->ctx);
+                loop->exit = new_label(gen->ctx);
+                loop->line_number = node->line_number;
+
+                IROperand start = IR_NO_OPERAND;
+                if (node->for_loop.init) {
+                    start = generate_ir_for_assignment(gen, ast_node(&gen->ctx->ast, node->for_loop.init));
+                }
+                describe_loop(gen, loop, node, start);
 
-            result_operand->type = OP_TEMP;
-            result_operand->name = new_temp();
-            add_expr_cache(op_type, op1.name, op2.name, result_operand->name);
+                // The condition is evaluated afresh on every trip round
+                IROperand header = loop->header, body = loop->body, latch = loop->latch, exit = loop->exit;
+                emit_label(gen, header, node->line_number);
+                if (node->for_loop.cond) generate_branch(gen, node->for_loop.cond, exit, false, node->line_number);
+                emit_label(gen, body, node->line_number);
 
-            IRInstruction* code3 = create_ir_instruction(op_type, node->line_number);
-            code3->result = *result_operand;
-            code3->arg1 = deep_copy_operand(&op1);
-            code3->arg2 = deep_copy_operand(&op2);
-            return append_ir(append_ir(code1, code2), code3);
+                // Then the body, the latch with its back-edge and the exit
+                push_jump(gen, IR_LABEL, exit, node->line_number);
+                push_jump(gen, IR_GOTO, header, node->line_number);
+                push_stmt(gen, node->for_loop.post);
+                push_jump(gen, IR_LABEL, latch, node->line_number);
+                push_stmt(gen, node->for_loop.body);
+                break;
+            }
+            case AST_STATEMENT_LIST:
+                push_stmt(gen, node->stmt_list.next);
+                push_stmt(gen, node->stmt_list.stmt);
+                break;
+            case AST_FUNCTION_CALL: {
+                // Called for its effect: the value is not kept
+                generate_ir_for_expression(gen, item.node, node->line_number);
+                gen->program->code[gen->program->count - 1].result = IR_NO_OPERAND;
+                break;
+            }
+            case AST_FUNCTION_DECL:
+                queue_function(gen, item.node);
+                break;
+            default:
+                break;
         }
-        default:
-            return NULL;
     }
 }
 
-IRInstruction* generate_ir(ASTNode* node) {
-    temp_count = 0;
-    label_count = 0;
-    expr_cache_count = 0; // Reset cache for each compilation
-    return generate_ir_for_statement(node);
+// Generate one unit: the program's statements at body, or a function's body
+// with its parameter list at params
+static void generate_unit(CompilerContext* ctx, IRProgram* unit, NodeId body, NodeId params,
+                          FunctionQueue* queue) {
+    IRGen gen;
+    memset(&gen, 0, sizeof(gen));
+    gen.ctx = ctx;
+    gen.program = unit;
+    gen.queue = queue;
+
+    // Parameters take the first variable numbers, in order. The list runs
+    // from the last parameter back.
+    for (NodeId p = params; p; p = ast_node(&ctx->ast, p)->id_list.next) unit->param_count++;
+    if (unit->param_count) {
+        const char** names = malloc(unit->param_count * sizeof(const char*));
+        if (!names) {
+            fprintf(stderr, "Error: out of memory in IR generation\n");
+            exit(1);
+        }
+        uint32_t i = unit->param_count;
+        for (NodeId p = params; p; p = ast_node(&ctx->ast, p)->id_list.next) {
+            names[--i] = ast_node(&ctx->ast, p)->id_list.id;
+        }
+        for (i = 0; i < unit->param_count; i++) variable_operand(&gen, names[i]);
+        free(names);
+    }
+
+    generate_ir_for_statements(&gen, body);
+    if ((uint32_t)ctx->ir.temp_count > unit->temp_count) {
+        unit->temp_count = (uint32_t)ctx->ir.temp_count;
+    }
+    free(gen.exprs);
+    free(gen.values);
+    free(gen.stmts);
+    free(gen.branches);
+    free(gen.variable_of);
+    free(gen.callee_of);
+}
+
+static void generate(CompilerContext* ctx, NodeId node, IRProgram* program) {
+    FunctionQueue queue = {0};
+    generate_unit(ctx, program, node, AST_NONE, &queue);
+
+    // Functions, nested ones included, in the order they were met. Each has
+    // temps of its own.
+    for (size_t i = 0; i < queue.count; i++) {
+        const ASTNode* decl = ast_node(&ctx->ast, queue.items[i].decl);
+        NodeId body = decl->func_decl.body, params = decl->func_decl.params;
+        int line_number = decl->line_number;
+        IRProgram* unit = add_function(program, queue.items[i].name);
+        ctx->ir.temp_count = 0;
+        ctx->ir.expr_cache_count = 0;
+        generate_unit(ctx, unit, body, params, &queue);
+        ir_append(unit, IR_RETURN, line_number);
+    }
+    free(queue.items);
+}
+
+void generate_ir(CompilerContext* ctx, NodeId node, IRProgram* program) {
+    ctx->ir.temp_count = 0;
+    ctx->ir.label_count = 0;
+    ctx->ir.expr_cache_count = 0; // Reset cache for each compilation
+    generate(ctx, node, program);
 }
 
-// --- Printing and Freeing ---
-void print_operand(IROperand op) {
-    switch (op.type) {
-        case OP_CONSTANT: printf("%d", op.constant); break;
-        case OP_VARIABLE:
-        case OP_TEMP:
-        case OP_LABEL:
-            if (op.name) printf("%s", op.name);
-            break;
+void generate_ir_statement(CompilerContext* ctx, NodeId statement, IRProgram* program) {
+    // No temp outlives its statement, so numbering can start over. The memo
+    // must not hand out temps of a statement that has already been optimized
+    // and emitted.
+    ctx->ir.temp_count = 0;
+    ctx->ir.expr_cache_count = 0;
+    generate(ctx, statement, program);
+}
+
+// --- Printing ---
+void print_operand(FILE* out, const IRProgram* program, IROperand op) {
+    uint32_t index = ir_operand_index(op);
+    switch (ir_operand_kind(op)) {
+        case OP_CONSTANT: fprintf(out, "%d", program->constants[index]); break;
+        case OP_VARIABLE: fprintf(out, "%s", program->variables[index]); break;
+        case OP_TEMP: fprintf(out, "t%u", index); break;
+        case OP_LABEL: fprintf(out, "L%u", index); break;
+        case OP_FUNCTION: fprintf(out, "%s", program->callees[index]); break;
         case OP_EMPTY: break;
     }
 }
 
-void print_ir(IRInstruction* head) {
-    for (IRInstruction* current = head; current; current = current->next) {
+static void print_code(FILE* out, const IRProgram* program) {
+    for (size_t i = 0; i < program->count; i++) {
+        const IRInstruction* current = &program->code[i];
         if (current->op == IR_LABEL) {
-            print_operand(current->result);
-            printf(":");
+            print_operand(out, program, current->result);
+            fprintf(out, ":");
         } else {
-            printf("    "); // Indent instructions
+            fprintf(out, "    "); // Indent instructions
             switch (current->op) {
                 case IR_ASSIGN:
-                    print_operand(current->result);
-                    printf(" = ");
-                    print_operand(current->arg1);
+                    print_operand(out, program, current->result);
+                    fprintf(out, " = ");
+                    print_operand(out, program, current->arg1);
                     break;
                 case IR_ADD:
                 case IR_SUB:
                 case IR_MUL:
                 case IR_DIV:
-                    print_operand(current->result);
-                    printf(" = ");
-                    print_operand(current->arg1);
-                    printf(" %c ", current->op == IR_ADD ? '+' : current->op == IR_SUB ? '-' : current->op == IR_MUL ? '*' : '/');
-                    print_operand(current->arg2);
+                    print_operand(out, program, current->result);
+                    fprintf(out, " = ");
+                    print_operand(out, program, current->arg1);
+                    fprintf(out, " %c ", current->op == IR_ADD ? '+' : current->op == IR_SUB ? '-' : current->op == IR_MUL ? '*' : '/');
+                    print_operand(out, program, current->arg2);
                     break;
                 case IR_GOTO:
-                    printf("goto ");
-                    print_operand(current->result);
+                    fprintf(out, "goto ");
+                    print_operand(out, program, current->result);
+                    break;
+                case IR_IF_EQ:
+                case IR_IF_NE:
+                case IR_IF_LT:
+                case IR_IF_LE:
+                case IR_IF_GT:
+                case IR_IF_GE: {
+                    static const char* const relations[] = { "==", "!=", "<", "<=", ">", ">=" };
+                    fprintf(out, "if ");
+                    print_operand(out, program, current->arg1);
+                    fprintf(out, " %s ", relations[current->op - IR_IF_EQ]);
+                    print_operand(out, program, current->arg2);
+                    fprintf(out, " goto ");
+                    print_operand(out, program, current->result);
+                    break;
+                }
+                case IR_PARAM:
+                    fprintf(out, "param ");
+                    print_operand(out, program, current->arg1);
                     break;
-                case IR_IF_GOTO:
-                    printf("if ");
-                    print_operand(current->arg1);
-                    printf(" goto ");
-                    print_operand(current->result);
+                case IR_CALL:
+                    if (current->result) {
+                        print_operand(out, program, current->result);
+                        fprintf(out, " = ");
+                    }
+                    fprintf(out, "call ");
+                    print_operand(out, program, current->arg1);
+                    fprintf(out, ", ");
+                    print_operand(out, program, current->arg2);
+                    break;
+                case IR_RETURN:
+                    fprintf(out, "return");
+                    if (current->arg1) {
+                        fprintf(out, " ");
+                        print_operand(out, program, current->arg1);
+                    }
                     break;
                 default:
-                    printf("Unsupported IR op for printing");
+                    fprintf(out, "Unsupported IR op for printing");
             }
         }
-        printf("\n");
+        fprintf(out, "\n");
     }
 }
 
-void free_ir(IRInstruction* head) {
-    IRInstruction* current = head;
-    while (current) {
-        IRInstruction* next = current->next;
-        if(current->result.type == OP_VARIABLE || current->result.type == OP_TEMP || current->result.type == OP_LABEL) {
-            if(current->result.name) free(current->result.name);
-        }
-        if(current->arg1.type == OP_VARIABLE || current->arg1.type == OP_TEMP || current->arg1.type == OP_LABEL) {
-            if(current->arg1.name) free(current->arg1.name);
+void print_ir(FILE* out, const IRProgram* program) {
+    print_code(out, program);
+    for (size_t f = 0; f < program->function_count; f++) {
+        const IRProgram* unit = &program->functions[f];
+        fprintf(out, "function %s(", unit->name);
+        for (uint32_t p = 0; p < unit->param_count; p++) {
+            fprintf(out, "%s%s", p ? ", " : "", unit->variables[p]);
         }
-        if(current->arg2.type == OP_VARIABLE || current->arg2.type == OP_TEMP || current->arg2.type == OP_LABEL) {
-            if(current->arg2.name) free(current->arg2.name);
-        }
-        free(current);
-        current = next;
+        fprintf(out, "):\n");
+        print_code(out, unit);
     }
-}
\ No newline at end of file
+}
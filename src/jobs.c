@@ -0,0 +1,46 @@
+#include "jobs.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+    void (*job)(void* arg, size_t index);
+    void* arg;
+    size_t jobs;
+    atomic_size_t next;
+} JobQueue;
+
+static void* job_worker(void* p) {
+    JobQueue* queue = p;
+    size_t index;
+    while ((index = atomic_fetch_add(&queue->next, 1)) < queue->jobs) {
+        queue->job(queue->arg, index);
+    }
+    return NULL;
+}
+
+void run_jobs(int threads, size_t jobs, void (*job)(void*, size_t), void* arg) {
+    JobQueue queue = { job, arg, jobs };
+    atomic_init(&queue.next, 0);
+
+    pthread_t* workers = threads > 1 ? malloc((size_t)threads * sizeof(pthread_t)) : NULL;
+    int started = 0;
+    for (int i = 1; workers && i < threads && (size_t)i < jobs; i++) {
+        // A thread that fails to start just leaves its share to the others
+        if (pthread_create(&workers[started], NULL, job_worker, &queue) == 0) started++;
+    }
+    job_worker(&queue);
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+    free(workers);
+}
+
+int online_cpus(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
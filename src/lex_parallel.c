@@ -0,0 +1,286 @@
+#include "tokens.h"
+#include "scanner.h"
+#include "intern.h"
+#include "jobs.h"
+#include "parser.tab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Chunked lexing. The source is cut at newlines into one chunk per thread, and
+// every chunk is lexed on its own scanner, guessing that it starts outside any
+// comment. A serial pass then walks the chunks in order and re-lexes the few
+// whose guess was wrong:
+//
+//  - a chunk that really starts inside a /* comment (the previous chunk ended
+//    in that state) is lexed again from the right start condition;
+//  - a string literal may span lines, so a chunk boundary can cut one in two.
+//    The first half then shows up as an unmatched quote, and the chunk is
+//    lexed again joined with the next one until no quote is left unmatched.
+//
+// Everything else a token can match stops at a newline, so a chunk that passes
+// both checks is lexed exactly as the serial scanner would lex it.
+//
+// Workers do not touch the interner (its ids must come out in the serial
+// order) or stdout. Each keeps the names it sees in first-seen order; interning
+// those chunk by chunk reproduces the serial ids, and unknown-character
+// reports are printed in order during the same pass.
+
+// Below this many bytes per chunk, starting a thread costs more than it saves.
+#define MIN_CHUNK_SIZE (256 * 1024)
+
+// Names seen in one chunk, in order of first appearance.
+typedef struct {
+    const char** text;
+    uint32_t* length;
+    uint32_t* hash;
+    size_t count;
+    size_t capacity;
+    uint32_t* slots;  // open addressing; 0 is empty, otherwise index + 1
+    size_t slot_count;
+} ChunkNames;
+
+typedef struct {
+    size_t begin, end;      // byte range of the source
+    int start_condition;    // start condition the chunk was lexed from
+    int end_condition;
+    int lines;              // line breaks the scanner counted
+    size_t unknown_count;
+    bool clean;             // no unmatched quote
+    char* copy;             // private padded copy of the range; names point into it
+    TokenStream tokens;     // lines relative to the chunk, names as ChunkNames indices
+    ChunkNames names;
+
+    // Set by the merge
+    uint32_t first_line;
+    size_t first_token;
+    InternId* ids;          // ChunkNames index -> intern id
+} Chunk;
+
+static void* xrealloc(void* p, size_t size) {
+    void* grown = realloc(p, size);
+    if (!grown) {
+        fprintf(stderr, "Error: out of memory in parallel lexer\n");
+        exit(1);
+    }
+    return grown;
+}
+
+static void names_grow_slots(ChunkNames* names) {
+    size_t count = names->slot_count ? names->slot_count * 2 : 1024;
+    uint32_t* slots = xrealloc(NULL, count * sizeof(uint32_t));
+    memset(slots, 0, count * sizeof(uint32_t));
+    for (size_t n = 0; n < names->count; n++) {
+        size_t i = names->hash[n] & (count - 1);
+        while (slots[i]) i = (i + 1) & (count - 1);
+        slots[i] = (uint32_t)n + 1;
+    }
+    free(names->slots);
+    names->slots = slots;
+    names->slot_count = count;
+}
+
+static uint32_t names_add(ChunkNames* names, const char* text, size_t len) {
+    if ((names->count + 1) * 2 > names->slot_count) names_grow_slots(names);
+
+    uint32_t h = intern_hash(text, len);
+    size_t mask = names->slot_count - 1;
+    size_t i = h & mask;
+    while (names->slots[i]) {
+        size_t n = names->slots[i] - 1;
+        if (names->hash[n] == h && names->length[n] == len &&
+            memcmp(names->text[n], text, len) == 0) {
+            return (uint32_t)n;
+        }
+        i = (i + 1) & mask;
+    }
+
+    if (names->count == names->capacity) {
+        names->capacity = names->capacity ? names->capacity * 2 : 256;
+        names->text = xrealloc(names->text, names->capacity * sizeof(*names->text));
+        names->length = xrealloc(names->length, names->capacity * sizeof(*names->length));
+        names->hash = xrealloc(names->hash, names->capacity * sizeof(*names->hash));
+    }
+    size_t n = names->count++;
+    names->text[n] = text;
+    names->length[n] = (uint32_t)len;
+    names->hash[n] = h;
+    names->slots[i] = (uint32_t)n + 1;
+    return (uint32_t)n;
+}
+
+static void chunk_clear(Chunk* c) {
+    free(c->copy);
+    token_stream_free(&c->tokens);
+    free(c->names.text);
+    free(c->names.length);
+    free(c->names.hash);
+    free(c->names.slots);
+    free(c->ids);
+    c->copy = NULL;
+    c->ids = NULL;
+    memset(&c->names, 0, sizeof(c->names));
+}
+
+static void lex_chunk(Chunk* c, const char* source) {
+    size_t size = c->end - c->begin;
+    c->copy = xrealloc(NULL, size + 2);
+    memcpy(c->copy, source + c->begin, size);
+    c->copy[size] = '\0';
+    c->copy[size + 1] = '\0';
+    c->clean = true;
+    c->unknown_count = 0;
+
+    ScanState state = { 1, true, NULL, NULL };
+    yyscan_t scanner;
+    if (yylex_init_extra(&state, &scanner) != 0) {
+        fprintf(stderr, "Error: cannot create scanner\n");
+        exit(1);
+    }
+    scanner_scan_buffer(scanner, c->copy, size + 2);
+    scanner_begin(scanner, c->start_condition);
+
+    YYSTYPE value;
+    int tok;
+    while ((tok = yylex(&value, scanner)) != 0) {
+        char* text = yyget_text(scanner);
+        int length = yyget_leng(scanner);
+        int32_t stored = 0;
+        switch (tok) {
+            case NUMBER:
+                stored = value.int_val;
+                break;
+            case IDENTIFIER:
+                stored = (int32_t)names_add(&c->names, text, (size_t)length);
+                break;
+            case STRING:
+                // Decoded in place: the scanner never looks back at matched text.
+                stored = (int32_t)names_add(&c->names, text,
+                                            unescape_string(text, text, (size_t)length));
+                break;
+            case UNKNOWN:
+                c->unknown_count++;
+                if (text[0] == '"') c->clean = false;
+                break;
+            default:
+                break;
+        }
+        token_stream_push(&c->tokens, tok, (uint32_t)(c->begin + (size_t)(text - c->copy)),
+                          (uint32_t)length, (uint32_t)state.line, stored);
+    }
+    c->end_condition = scanner_start_condition(scanner);
+    c->lines = state.line - 1;
+    yylex_destroy(scanner);
+}
+
+typedef struct {
+    Chunk* chunks;
+    const char* source;
+    TokenStream* out;
+} ParallelLex;
+
+static void lex_chunk_job(void* arg, size_t index) {
+    ParallelLex* lex = arg;
+    lex_chunk(&lex->chunks[index], lex->source);
+}
+
+static void copy_chunk_job(void* arg, size_t index) {
+    ParallelLex* lex = arg;
+    const Chunk* c = &lex->chunks[index];
+    const TokenStream* from = &c->tokens;
+    TokenStream* to = lex->out;
+    size_t at = c->first_token;
+    const uint8_t ident = IDENTIFIER - TOKEN_KIND_BASE;
+    const uint8_t string = STRING - TOKEN_KIND_BASE;
+
+    memcpy(to->kind + at, from->kind, from->count * sizeof(*from->kind));
+    memcpy(to->offset + at, from->offset, from->count * sizeof(*from->offset));
+    memcpy(to->length + at, from->length, from->count * sizeof(*from->length));
+    for (size_t i = 0; i < from->count; i++) {
+        uint8_t kind = from->kind[i];
+        int32_t value = from->value[i];
+        to->line[at + i] = from->line[i] + c->first_line - 1;
+        to->value[at + i] = (kind == ident || kind == string) ? (int32_t)c->ids[value] : value;
+    }
+}
+
+void lex_token_stream_parallel(Interner* names, TokenStream* ts, char* base, size_t size,
+                               int threads) {
+    if (threads <= 0) threads = online_cpus();
+    size_t count = (size_t)threads;
+    if (count > size / MIN_CHUNK_SIZE) count = size / MIN_CHUNK_SIZE;
+    if (count < 2) {
+        lex_token_stream(names, ts, base, size);
+        return;
+    }
+
+    // Cut at the first newline after each even share of the input
+    Chunk* chunks = xrealloc(NULL, count * sizeof(Chunk));
+    memset(chunks, 0, count * sizeof(Chunk));
+    size_t n = 0;
+    for (size_t begin = 0; begin < size && n < count; n++) {
+        size_t end = size;
+        if (n + 1 < count) {
+            size_t target = begin + (size - begin) / (count - n);
+            const char* newline = memchr(base + target, '\n', size - target);
+            if (newline) end = (size_t)(newline - base) + 1;
+        }
+        chunks[n].begin = begin;
+        chunks[n].end = end;
+        chunks[n].start_condition = SCAN_INITIAL;
+        begin = end;
+    }
+
+    ParallelLex lex = { chunks, base, ts };
+    run_jobs(threads, n, lex_chunk_job, &lex);
+
+    // Check each chunk's guess against where the previous one really ended
+    int condition = SCAN_INITIAL;
+    uint32_t line = 1;
+    size_t total = ts->count;
+    size_t kept = 0;
+    for (size_t k = 0; k < n;) {
+        Chunk c = chunks[k++];
+        if (c.start_condition != condition) {
+            chunk_clear(&c);
+            c.start_condition = condition;
+            lex_chunk(&c, base);
+        }
+        while (!c.clean && k < n) {
+            chunk_clear(&c);
+            c.end = chunks[k].end;
+            chunk_clear(&chunks[k++]);
+            lex_chunk(&c, base);
+        }
+        c.first_line = line;
+        c.first_token = total;
+        line += (uint32_t)c.lines;
+        total += c.tokens.count;
+        condition = c.end_condition;
+        chunks[kept++] = c;
+    }
+
+    // Intern names and report unknown characters in source order
+    for (size_t k = 0; k < kept; k++) {
+        Chunk* c = &chunks[k];
+        c->ids = xrealloc(NULL, (c->names.count + 1) * sizeof(InternId));
+        for (size_t i = 0; i < c->names.count; i++) {
+            c->ids[i] = intern_id(intern_hashed(names, c->names.text[i], c->names.length[i],
+                                                c->names.hash[i]));
+        }
+        for (size_t i = 0; c->unknown_count && i < c->tokens.count; i++) {
+            if (c->tokens.kind[i] == UNKNOWN - TOKEN_KIND_BASE) {
+                report_unknown_character((int)(c->tokens.line[i] + c->first_line - 1),
+                                         base + c->tokens.offset[i], (int)c->tokens.length[i]);
+            }
+        }
+    }
+
+    token_stream_reserve(ts, total + 1);
+    run_jobs(threads, kept, copy_chunk_job, &lex);
+    ts->count = total;
+    token_stream_push(ts, 0, (uint32_t)size, 0, line, 0);
+
+    for (size_t k = 0; k < kept; k++) chunk_clear(&chunks[k]);
+    free(chunks);
+}
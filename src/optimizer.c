@@ -1,31 +1,84 @@
 #include "optimizer.h"
 #include "ir.h"
+#include "cfg.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// This is a forward declaration, as print_ir is in ir.c but useful for debugging here
-void print_ir(IRInstruction* head);
-void print_operand(IROperand op);
+// Optimizer chatter is only produced when the driver asked for the opt-ir dump
+#define TRACE(...) do { if (trace) fprintf(trace, __VA_ARGS__); } while (0)
 
-void optimize_ir(IRInstruction* head) {
+// Most binary operations CSE keeps as candidates at once
+#define CSE_WINDOW 256
+
+// How often a loop's body runs, or -1 when that is not known before it runs:
+// the induction variable must start at a constant, be compared with a constant
+// and change only in the latch.
+static long long loop_trip_count(const IRProgram* program, const IRLoop* loop) {
+    if (!loop->induction || loop->step == 0 ||
+        ir_operand_kind(loop->start) != OP_CONSTANT || ir_operand_kind(loop->bound) != OP_CONSTANT) {
+        return -1;
+    }
+    size_t i = 0;
+    while (i < program->count && !(program->code[i].op == IR_LABEL && program->code[i].result == loop->body)) i++;
+    for (; i < program->count; i++) {
+        const IRInstruction* current = &program->code[i];
+        if (current->op == IR_LABEL && current->result == loop->latch) break;
+        if (current->op != IR_LABEL && !ir_is_jump(current->op) && current->result == loop->induction) {
+            return -1;
+        }
+    }
+
+    long long start = ir_constant_value(program, loop->start);
+    long long bound = ir_constant_value(program, loop->bound);
+    long long step = loop->step;
+    switch (loop->compare) {
+        case AST_OP_LT:
+            if (start >= bound) return 0;
+            return step > 0 ? (bound - start + step - 1) / step : -1;
+        case AST_OP_LEQ:
+            if (start > bound) return 0;
+            return step > 0 ? (bound - start) / step + 1 : -1;
+        case AST_OP_GT:
+            if (start <= bound) return 0;
+            return step < 0 ? (start - bound - step - 1) / -step : -1;
+        case AST_OP_GEQ:
+            if (start < bound) return 0;
+            return step < 0 ? (start - bound) / -step + 1 : -1;
+        default:
+            return -1;
+    }
+}
+
+// Run the passes over one unit; returns whether any of them changed it
+//
+// The control-flow graph is built once, up front. No pass adds or removes a
+// label, jump or return, so the blocks and edges hold throughout; passes that
+// remove instructions compact the code one block at a time and store each
+// block's new range.
+static bool optimize_unit(IRProgram* program, FILE* trace, bool keep_variables) {
+    IRInstruction* code = program->code;
     bool optimized_this_pass = false;
-    printf("--- OPTIMIZER START ---\n");
-    printf("Running optimizer...\n");
+    CFG cfg;
+    cfg_build(&cfg, program);
 
     // 1. Constant Folding (already implemented)
-    for (IRInstruction* current = head; current; current = current->next) {
-        if (current->arg1.type == OP_CONSTANT && current->arg2.type == OP_CONSTANT) {
+    for (size_t i = 0; i < program->count; i++) {
+        IRInstruction* current = &code[i];
+        if (ir_operand_kind(current->arg1) == OP_CONSTANT &&
+            ir_operand_kind(current->arg2) == OP_CONSTANT) {
+            int left = ir_constant_value(program, current->arg1);
+            int right = ir_constant_value(program, current->arg2);
             int result_val = 0;
             bool folded = true;
             IROp op = current->op;
             switch (op) {
-                case IR_ADD: result_val = current->arg1.constant + current->arg2.constant; break;
-                case IR_SUB: result_val = current->arg1.constant - current->arg2.constant; break;
-                case IR_MUL: result_val = current->arg1.constant * current->arg2.constant; break;
+                case IR_ADD: result_val = left + right; break;
+                case IR_SUB: result_val = left - right; break;
+                case IR_MUL: result_val = left * right; break;
                 case IR_DIV: 
-                    if (current->arg2.constant != 0) {
-                        result_val = current->arg1.constant / current->arg2.constant;
+                    if (right != 0) {
+                        result_val = left / right;
                     } else {
                         folded = false; // Avoid division by zero
                     }
@@ -35,12 +88,10 @@ void optimize_ir(IRInstruction* head) {
                     break;
             }
             if (folded) {
-                printf("Applied: Constant Folding at line %d\n", current->line_number);
+                TRACE("Applied: Constant Folding at line %d\n", current->line_number);
                 current->op = IR_ASSIGN;
-                current->arg1.type = OP_CONSTANT;
-                current->arg1.constant = result_val;
-                current->arg2.type = OP_EMPTY;
-                current->arg2.name = NULL;
+                current->arg1 = ir_add_constant(program, result_val);
+                current->arg2 = IR_NO_OPERAND;
                 optimized_this_pass = true;
             }
         }
@@ -49,139 +100,173 @@ void optimize_ir(IRInstruction* head) {
     // 2. Dead Code Elimination
     // Remove assignments whose result is never used
     // (Simple liveness analysis: mark all used temps/vars, then remove unused assignments)
-    // First, mark all used variables/temps
-    IRInstruction* curr = head;
-    char* used[1024];
-    int used_count = 0;
-    for (curr = head; curr; curr = curr->next) {
-        if (curr->arg1.type == OP_VARIABLE || curr->arg1.type == OP_TEMP) {
-            used[used_count++] = curr->arg1.name;
-        }
-        if (curr->arg2.type == OP_VARIABLE || curr->arg2.type == OP_TEMP) {
-            used[used_count++] = curr->arg2.name;
+    // First, mark all used variables/temps: both are numbered densely, so
+    // one flag per number does
+    uint8_t* used_temps = calloc(program->temp_count + 1, 1);
+    uint8_t* used_variables = calloc(program->variable_count + 1, 1);
+    if (!used_temps || !used_variables) {
+        fprintf(stderr, "Error: out of memory in optimizer\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < program->count; i++) {
+        const IRInstruction* curr = &code[i];
+        IROperand args[2] = { curr->arg1, curr->arg2 };
+        for (int a = 0; a < 2; a++) {
+            if (ir_operand_kind(args[a]) == OP_TEMP) used_temps[ir_operand_index(args[a])] = 1;
+            if (ir_operand_kind(args[a]) == OP_VARIABLE) used_variables[ir_operand_index(args[a])] = 1;
         }
     }
-    // Remove assignments to unused temps/vars
-    IRInstruction* prev = NULL;
-    curr = head;
-    while (curr) {
-        int is_used = 0;
-        if ((curr->op == IR_ASSIGN || curr->op == IR_ADD || curr->op == IR_SUB || curr->op == IR_MUL || curr->op == IR_DIV) &&
-            (curr->result.type == OP_TEMP || curr->result.type == OP_VARIABLE)) {
-            for (int i = 0; i < used_count; i++) {
-                if (curr->result.name && used[i] && strcmp(curr->result.name, used[i]) == 0) {
-                    is_used = 1;
-                    break;
+    // Remove assignments to unused temps/vars. Kept instructions are moved
+    // down over the removed ones.
+    size_t kept = 0;
+    for (size_t b = 0; b < cfg.block_count; b++) {
+        IRBlock* block = &cfg.blocks[b];
+        size_t first = kept;
+        for (size_t i = block->first; i < block->end; i++) {
+            const IRInstruction* curr = &code[i];
+            IROperandKind result_kind = ir_operand_kind(curr->result);
+            if ((curr->op == IR_ASSIGN || curr->op == IR_ADD || curr->op == IR_SUB || curr->op == IR_MUL || curr->op == IR_DIV) &&
+                (result_kind == OP_TEMP ||
+                 (result_kind == OP_VARIABLE && !keep_variables))) {
+                uint8_t* used = result_kind == OP_TEMP ? used_temps : used_variables;
+                if (!used[ir_operand_index(curr->result)]) {
+                    TRACE("Applied: Dead Code Elimination at line %d\n", curr->line_number);
+                    optimized_this_pass = true;
+                    continue;
                 }
             }
-            if (!is_used) {
-                printf("Applied: Dead Code Elimination at line %d\n", curr->line_number);
-                if (prev) prev->next = curr->next;
-                else head = curr->next;
-                IRInstruction* to_free = curr;
-                curr = curr->next;
-                free(to_free);
-                optimized_this_pass = true;
-                continue;
-            }
+            code[kept++] = *curr;
         }
-        prev = curr;
-        curr = curr->next;
+        block->first = first;
+        block->end = kept;
     }
+    program->count = kept;
+    free(used_temps);
+    free(used_variables);
 
     // 3. Common Subexpression Elimination
-    // For each binary op, check if an identical op with same args exists before
-    IRInstruction* outer = head;
-    while (outer) {
-        if (outer->op == IR_ADD || outer->op == IR_SUB || outer->op == IR_MUL || outer->op == IR_DIV) {
-            IRInstruction* inner = head;
-            while (inner != outer) {
-                if (inner->op == outer->op &&
-                    ((inner->arg1.type == outer->arg1.type && inner->arg2.type == outer->arg2.type &&
-                      inner->arg1.name && outer->arg1.name && strcmp(inner->arg1.name, outer->arg1.name) == 0 &&
-                      inner->arg2.name && outer->arg2.name && strcmp(inner->arg2.name, outer->arg2.name) == 0)
-                    ||
-                    (inner->arg1.type == outer->arg2.type && inner->arg2.type == outer->arg1.type &&
-                     inner->arg1.name && outer->arg2.name && strcmp(inner->arg1.name, outer->arg2.name) == 0 &&
-                     inner->arg2.name && outer->arg1.name && strcmp(inner->arg2.name, outer->arg1.name) == 0))
-                ) {
-                    // Found common subexpression (allow commutativity for + and *)
-                    printf("Applied: Common Subexpression Elimination at line %d\n", outer->line_number);
-                    // Replace all uses of outer->result with inner->result
-                    IRInstruction* replace = outer->next;
-                    while (replace) {
-                        if (replace->arg1.type == outer->result.type && replace->arg1.name && strcmp(replace->arg1.name, outer->result.name) == 0) {
-                            replace->arg1.name = inner->result.name;
-                        }
-                        if (replace->arg2.type == outer->result.type && replace->arg2.name && strcmp(replace->arg2.name, outer->result.name) == 0) {
-                            replace->arg2.name = inner->result.name;
+    // For each binary op, check if an identical op with same args is still
+    // available: computed earlier in the same basic block, with neither
+    // operand assigned since. Values do not carry over from one block to
+    // the next, since it may be entered from elsewhere.
+    size_t* available = malloc(CSE_WINDOW * sizeof(size_t));  // indices of kept binary ops
+    if (!available) {
+        fprintf(stderr, "Error: out of memory in optimizer\n");
+        exit(1);
+    }
+    kept = 0;
+    for (size_t b = 0; b < cfg.block_count; b++) {
+        IRBlock* block = &cfg.blocks[b];
+        size_t first = kept;
+        size_t available_count = 0;
+        for (size_t o = block->first; o < block->end; o++) {
+            IRInstruction* outer = &code[o];
+            if (outer->op == IR_ADD || outer->op == IR_SUB || outer->op == IR_MUL || outer->op == IR_DIV) {
+                bool commutative = outer->op == IR_ADD || outer->op == IR_MUL;
+                for (size_t n = 0; n < available_count; n++) {
+                    const IRInstruction* inner = &code[available[n]];
+                    if (inner->op == outer->op && outer->arg1 && outer->arg2 &&
+                        ((inner->arg1 == outer->arg1 && inner->arg2 == outer->arg2)
+                        ||
+                        (commutative && inner->arg1 == outer->arg2 && inner->arg2 == outer->arg1))
+                    ) {
+                        // Found common subexpression (allow commutativity for + and *)
+                        TRACE("Applied: Common Subexpression Elimination at line %d\n", outer->line_number);
+                        // Replace all uses of outer->result with inner->result
+                        for (size_t r = o + 1; r < program->count; r++) {
+                            IRInstruction* replace = &code[r];
+                            if (replace->arg1 == outer->result) {
+                                replace->arg1 = inner->result;
+                            }
+                            if (replace->arg2 == outer->result) {
+                                replace->arg2 = inner->result;
+                            }
                         }
-                        replace = replace->next;
+                        // Remove outer
+                        optimized_this_pass = true;
+                        goto next_outer;
                     }
-                    // Remove outer
-                    if (prev) prev->next = outer->next;
-                    else head = outer->next;
-                    IRInstruction* to_free = outer;
-                    outer = outer->next;
-                    free(to_free);
-                    optimized_this_pass = true;
-                    goto next_outer;
                 }
-                inner = inner->next;
             }
+            code[kept] = *outer;
+            // An assignment invalidates every available expression that reads
+            // its target
+            if (outer->result && outer->op != IR_LABEL && !ir_is_jump(outer->op)) {
+                size_t still = 0;
+                for (size_t n = 0; n < available_count; n++) {
+                    const IRInstruction* inner = &code[available[n]];
+                    if (inner->arg1 != outer->result && inner->arg2 != outer->result) {
+                        available[still++] = available[n];
+                    }
+                }
+                available_count = still;
+            }
+            if ((outer->op == IR_ADD || outer->op == IR_SUB || outer->op == IR_MUL || outer->op == IR_DIV) &&
+                available_count < CSE_WINDOW) {
+                available[available_count++] = kept;
+            }
+            kept++;
+            next_outer: ;
         }
-        prev = outer;
-        outer = outer->next;
-        next_outer: ;
+        block->first = first;
+        block->end = kept;
     }
+    program->count = kept;
+    free(available);
 
     // 4. Strength Reduction (expanded)
-    for (IRInstruction* current = head; current; current = current->next) {
-        // Multiplication by 2^n -> shift left
+    for (size_t i = 0; i < program->count; i++) {
+        IRInstruction* current = &code[i];
+        // Multiplication by a constant
         if (current->op == IR_MUL) {
-            if (current->arg2.type == OP_CONSTANT) {
-                int c = current->arg2.constant;
-                if (c > 0 && (c & (c - 1)) == 0) { // power of 2
-                    printf("Applied: Strength Reduction at line %d\n", current->line_number);
-                    current->op = IR_ADD; // For simplicity, use addition (no shift op in IR)
-                    for (int i = 1; i < c; i++) {
-                        // Add arg1 to itself c-1 times
-                        // This is a simplification; a real shift would be better
-                        // But IR does not have shift, so we use repeated addition
-                    }
+            if (ir_operand_kind(current->arg2) == OP_CONSTANT) {
+                int c = ir_constant_value(program, current->arg2);
+                // The IR has no shift, so only x * 1 and x * 2 have a
+                // cheaper form: a copy and an addition
+                if (c == 1) {
+                    current->op = IR_ASSIGN;
+                    current->arg2 = IR_NO_OPERAND;
+                    TRACE("Applied: Strength Reduction at line %d\n", current->line_number);
                     optimized_this_pass = true;
                 } else if (c == 2) {
                     current->op = IR_ADD;
                     current->arg2 = current->arg1;
-                    printf("Applied: Strength Reduction at line %d\n", current->line_number);
+                    TRACE("Applied: Strength Reduction at line %d\n", current->line_number);
                     optimized_this_pass = true;
                 }
             }
         }
     }
 
-    // 5. Loop Unrolling (simple stub for for-loops with known count)
-    // This requires recognizing loop patterns in IR, which is non-trivial.
-    // Here, we just print a message for demonstration.
-    for (IRInstruction* current = head; current; current = current->next) {
-        if (current->op == IR_LABEL && current->result.name && strstr(current->result.name, "L")) {
-            // Look for a pattern: LABEL, ... , GOTO LABEL
-            IRInstruction* scan = current->next;
-            while (scan) {
-                if (scan->op == IR_GOTO && scan->result.name && strcmp(scan->result.name, current->result.name) == 0) {
-                    printf("Applied: Loop Unrolling at line %d\n", current->line_number);
-                    // TODO: Actually duplicate the loop body for a fixed number of iterations
-                    break;
-                }
-                scan = scan->next;
-            }
+    // 5. Loop Unrolling (stub: loops with a known trip count are found, but
+    // not yet unrolled)
+    for (size_t l = 0; l < program->loop_count; l++) {
+        const IRLoop* loop = &program->loops[l];
+        long long trips = loop_trip_count(program, loop);
+        if (trips >= 0) {
+            TRACE("Loop at line %d runs %lld times\n", loop->line_number, trips);
+            // TODO: Actually duplicate the loop body for a fixed number of iterations
         }
     }
 
-    if (!optimized_this_pass) {
-        printf("    No applicable optimizations found.\n");
+    cfg_free(&cfg);
+    return optimized_this_pass;
+}
+
+void optimize_ir(IRProgram* program, FILE* trace, bool keep_variables) {
+    TRACE("--- OPTIMIZER START ---\n");
+    TRACE("Running optimizer...\n");
+    bool optimized = optimize_unit(program, trace, keep_variables);
+    // A function's variables are its own, so none outlives its code
+    for (size_t f = 0; f < program->function_count; f++) {
+        optimized |= optimize_unit(&program->functions[f], trace, false);
+    }
+    if (!optimized) {
+        TRACE("    No applicable optimizations found.\n");
+    }
+    if (trace) {
+        fprintf(trace, "--- OPTIMIZED IR ---\n");
+        print_ir(trace, program);
+        fprintf(trace, "--- OPTIMIZER END ---\n");
     }
-    printf("--- OPTIMIZED IR ---\n");
-    print_ir(head);
-    printf("--- OPTIMIZER END ---\n");
 } 
\ No newline at end of file
@@ -1,23 +1,22 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* A Bison parser, made by GNU Bison 2.4.1.  */
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-/* Skeleton implementation for Bison's Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
-   
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -28,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -42,172 +45,229 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.4.1"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
 
 /* Push parsers.  */
-#define YYPUSH 0
+#define YYPUSH 1
 
 /* Pull parsers.  */
 #define YYPULL 1
 
-/* Using locations.  */
-#define YYLSP_NEEDED 0
-
 
 
-/* Copy the first part of user declarations.  */
 
-/* Line 189 of yacc.c  */
+/* First part of user prologue.  */
 #line 1 "src/parser.y"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "globals.h"
+#include "context.h"
 #include "ast.h"
 #include "semantic.h"
+#include "tokens.h"
 
-bool check_semantics(ASTNode* root, SymbolTable* table);
-
-extern int yylex();
-extern int yyparse();
-extern int line_num;
-extern ASTNode* root;  // Declare root as external
-extern ASTNode* ast_root;  // Declare ast_root as external
-void yyerror(const char* msg);
-
-
-/* Line 189 of yacc.c  */
-#line 92 "src/parser.tab.c"
-
-/* Enabling traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Enabling the token table.  */
-#ifndef YYTOKEN_TABLE
-# define YYTOKEN_TABLE 0
-#endif
-
-
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     UNKNOWN = 258,
-     IDENTIFIER = 259,
-     NUMBER = 260,
-     STRING = 261,
-     LET = 262,
-     FUNCTION = 263,
-     IF = 264,
-     ELSE = 265,
-     FOR = 266,
-     TAKE = 267,
-     PUBLISH = 268,
-     EQ = 269,
-     NEQ = 270,
-     LEQ = 271,
-     GEQ = 272,
-     AND = 273,
-     OR = 274,
-     ASSIGN = 275,
-     LT = 276,
-     GT = 277,
-     PLUS = 278,
-     MINUS = 279,
-     MUL = 280,
-     DIV = 281,
-     NOT = 282,
-     LPAREN = 283,
-     RPAREN = 284,
-     LBRACE = 285,
-     RBRACE = 286,
-     COMMA = 287,
-     SEMICOLON = 288
-   };
-#endif
+// Tokens are pulled through next_token(), which replays a pre-lexed token
+// stream when one is set (see tokens.h) and otherwise calls the scanner.
+#define yylex next_token
+void yyerror(CompilerContext* ctx, const char* msg);
 
+#line 86 "src/parser.tab.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+#include "parser.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_UNKNOWN = 3,                    /* UNKNOWN  */
+  YYSYMBOL_IDENTIFIER = 4,                 /* IDENTIFIER  */
+  YYSYMBOL_NUMBER = 5,                     /* NUMBER  */
+  YYSYMBOL_STRING = 6,                     /* STRING  */
+  YYSYMBOL_LET = 7,                        /* LET  */
+  YYSYMBOL_FUNCTION = 8,                   /* FUNCTION  */
+  YYSYMBOL_IF = 9,                         /* IF  */
+  YYSYMBOL_ELSE = 10,                      /* ELSE  */
+  YYSYMBOL_FOR = 11,                       /* FOR  */
+  YYSYMBOL_TAKE = 12,                      /* TAKE  */
+  YYSYMBOL_PUBLISH = 13,                   /* PUBLISH  */
+  YYSYMBOL_EQ = 14,                        /* EQ  */
+  YYSYMBOL_NEQ = 15,                       /* NEQ  */
+  YYSYMBOL_LEQ = 16,                       /* LEQ  */
+  YYSYMBOL_GEQ = 17,                       /* GEQ  */
+  YYSYMBOL_AND = 18,                       /* AND  */
+  YYSYMBOL_OR = 19,                        /* OR  */
+  YYSYMBOL_ASSIGN = 20,                    /* ASSIGN  */
+  YYSYMBOL_LT = 21,                        /* LT  */
+  YYSYMBOL_GT = 22,                        /* GT  */
+  YYSYMBOL_PLUS = 23,                      /* PLUS  */
+  YYSYMBOL_MINUS = 24,                     /* MINUS  */
+  YYSYMBOL_MUL = 25,                       /* MUL  */
+  YYSYMBOL_DIV = 26,                       /* DIV  */
+  YYSYMBOL_NOT = 27,                       /* NOT  */
+  YYSYMBOL_LPAREN = 28,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 29,                    /* RPAREN  */
+  YYSYMBOL_LBRACE = 30,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 31,                    /* RBRACE  */
+  YYSYMBOL_COMMA = 32,                     /* COMMA  */
+  YYSYMBOL_SEMICOLON = 33,                 /* SEMICOLON  */
+  YYSYMBOL_YYACCEPT = 34,                  /* $accept  */
+  YYSYMBOL_program = 35,                   /* program  */
+  YYSYMBOL_top_level_list = 36,            /* top_level_list  */
+  YYSYMBOL_statement_list = 37,            /* statement_list  */
+  YYSYMBOL_statement = 38,                 /* statement  */
+  YYSYMBOL_variable_declaration = 39,      /* variable_declaration  */
+  YYSYMBOL_assignment = 40,                /* assignment  */
+  YYSYMBOL_if_statement = 41,              /* if_statement  */
+  YYSYMBOL_for_init = 42,                  /* for_init  */
+  YYSYMBOL_for_loop = 43,                  /* for_loop  */
+  YYSYMBOL_function_declaration = 44,      /* function_declaration  */
+  YYSYMBOL_function_scope = 45,            /* function_scope  */
+  YYSYMBOL_function_call = 46,             /* function_call  */
+  YYSYMBOL_input_statement = 47,           /* input_statement  */
+  YYSYMBOL_publish_statement = 48,         /* publish_statement  */
+  YYSYMBOL_identifier_list = 49,           /* identifier_list  */
+  YYSYMBOL_argument_list = 50,             /* argument_list  */
+  YYSYMBOL_expression = 51,                /* expression  */
+  YYSYMBOL_logical_or = 52,                /* logical_or  */
+  YYSYMBOL_logical_and = 53,               /* logical_and  */
+  YYSYMBOL_equality = 54,                  /* equality  */
+  YYSYMBOL_comparison = 55,                /* comparison  */
+  YYSYMBOL_term = 56,                      /* term  */
+  YYSYMBOL_factor = 57,                    /* factor  */
+  YYSYMBOL_unary = 58,                     /* unary  */
+  YYSYMBOL_primary = 59                    /* primary  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Line 214 of yacc.c  */
-#line 18 "src/parser.y"
 
-    int int_val;
-    char* string_val;
-    struct ASTNode* ast;
 
+/* Unqualified %code blocks.  */
+#line 20 "src/parser.y"
 
+static void append_statement(CompilerContext* ctx, StatementList* list, NodeId statement);
+static bool add_top_level_statement(CompilerContext* ctx, StatementList* list, NodeId statement);
 
-/* Line 214 of yacc.c  */
-#line 169 "src/parser.tab.c"
-} YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
-#endif
+#line 185 "src/parser.tab.c"
 
+#ifdef short
+# undef short
+#endif
 
-/* Copy the second part of user declarations.  */
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
-/* Line 264 of yacc.c  */
-#line 181 "src/parser.tab.c"
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-typedef signed char yytype_int8;
-#else
-typedef short int yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -215,85 +275,112 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
-# if YYENABLE_NLS
+# if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
 #   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
 #  endif
 # endif
 # ifndef YY_
-#  define YY_(msgid) msgid
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(e) ((void) (e))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(e) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(n) (n)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int yyi)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (yyi)
-    int yyi;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return yyi;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
 
-/* The parser invokes alloca or malloc; define the necessary symbols.  */
 
-# ifdef YYSTACK_USE_ALLOCA
-#  if YYSTACK_USE_ALLOCA
-#   ifdef __GNUC__
-#    define YYSTACK_ALLOC __builtin_alloca
-#   elif defined __BUILTIN_VA_ARG_INCR
-#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
-#   elif defined _AIX
-#    define YYSTACK_ALLOC __alloca
-#   elif defined _MSC_VER
-#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
-#    define alloca _alloca
-#   else
-#    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#     ifndef _STDLIB_H
-#      define _STDLIB_H 1
-#     endif
-#    endif
-#   endif
-#  endif
-# endif
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -307,111 +394,117 @@ YYID (yyi)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
 #   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
 #  endif
-#  if (defined __cplusplus && ! defined _STDLIB_H \
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#   ifndef _STDLIB_H
-#    define _STDLIB_H 1
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
 #   endif
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
-/* Copy COUNT objects from FROM to TO.  The source and destination do
-   not overlap.  */
-# ifndef YYCOPY
-#  if defined __GNUC__ && 1 < __GNUC__
-#   define YYCOPY(To, From, Count) \
-      __builtin_memcpy (To, From, (Count) * sizeof (*(From)))
-#  else
-#   define YYCOPY(To, From, Count)		\
-      do					\
-	{					\
-	  YYSIZE_T yyi;				\
-	  for (yyi = 0; yyi < (Count); yyi++)	\
-	    (To)[yyi] = (From)[yyi];		\
-	}					\
-      while (YYID (0))
-#  endif
-# endif
+# define YYCOPY_NEEDED 1
 
 /* Relocate STACK from its old location to the new one.  The
    local variables YYSIZE and YYSTACKSIZE give the old and new number of
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack_alloc, Stack)				\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack_alloc, Stack, yysize);			\
-	Stack = &yyptr->Stack_alloc;					\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  27
+#define YYFINAL  29
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   158
+#define YYLAST   175
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  34
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  24
+#define YYNNTS  26
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  56
-/* YYNRULES -- Number of states.  */
-#define YYNSTATES  122
+#define YYNRULES  60
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  127
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   288
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -445,318 +538,242 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint8 yyprhs[] =
-{
-       0,     0,     3,     5,     7,    10,    13,    16,    18,    20,
-      22,    25,    28,    31,    36,    40,    48,    60,    62,    64,
-      76,    85,    93,    98,   102,   105,   110,   112,   116,   118,
-     122,   124,   126,   130,   132,   136,   138,   142,   146,   148,
-     152,   156,   160,   164,   166,   170,   174,   176,   180,   184,
-     187,   190,   192,   194,   196,   198,   200
-};
-
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      35,     0,    -1,    36,    -1,    37,    -1,    36,    37,    -1,
-      38,    33,    -1,    39,    33,    -1,    40,    -1,    42,    -1,
-      43,    -1,    44,    33,    -1,    45,    33,    -1,    46,    33,
-      -1,     7,     4,    20,    49,    -1,     4,    20,    49,    -1,
-       9,    28,    49,    29,    30,    36,    31,    -1,     9,    28,
-      49,    29,    30,    36,    31,    10,    30,    36,    31,    -1,
-      38,    -1,    39,    -1,    11,    28,    41,    33,    49,    33,
-      39,    29,    30,    36,    31,    -1,     8,     4,    28,    47,
-      29,    30,    36,    31,    -1,     8,     4,    28,    29,    30,
-      36,    31,    -1,     4,    28,    48,    29,    -1,     4,    28,
-      29,    -1,    12,     4,    -1,    13,    28,    49,    29,    -1,
-       4,    -1,    47,    32,     4,    -1,    49,    -1,    48,    32,
-      49,    -1,    50,    -1,    51,    -1,    50,    19,    51,    -1,
-      52,    -1,    51,    18,    52,    -1,    53,    -1,    52,    14,
-      53,    -1,    52,    15,    53,    -1,    54,    -1,    53,    21,
-      54,    -1,    53,    16,    54,    -1,    53,    22,    54,    -1,
-      53,    17,    54,    -1,    55,    -1,    54,    23,    55,    -1,
-      54,    24,    55,    -1,    56,    -1,    55,    25,    56,    -1,
-      55,    26,    56,    -1,    27,    56,    -1,    24,    56,    -1,
-      57,    -1,     5,    -1,     6,    -1,     4,    -1,    44,    -1,
-      28,    49,    29,    -1
-};
-
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_uint8 yyrline[] =
 {
-       0,    41,    41,    49,    58,    75,    76,    77,    78,    79,
-      80,    81,    82,    86,    90,    94,    96,   101,   102,   106,
-     111,   113,   118,   120,   125,   129,   133,   134,   138,   139,
-     143,   147,   148,   152,   153,   157,   158,   159,   163,   164,
-     165,   166,   167,   171,   172,   173,   177,   178,   179,   183,
-     184,   185,   189,   190,   191,   192,   193
+       0,    59,    59,    67,    71,    78,    82,    89,    90,    91,
+      92,    93,    94,    95,    96,    99,   103,   107,   111,   113,
+     118,   119,   123,   128,   133,   142,   146,   148,   153,   157,
+     161,   162,   166,   167,   171,   175,   176,   180,   181,   185,
+     186,   187,   191,   192,   193,   194,   195,   199,   200,   201,
+     205,   206,   207,   211,   212,   213,   217,   218,   219,   220,
+     221
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || YYTOKEN_TABLE
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "UNKNOWN", "IDENTIFIER", "NUMBER",
-  "STRING", "LET", "FUNCTION", "IF", "ELSE", "FOR", "TAKE", "PUBLISH",
-  "EQ", "NEQ", "LEQ", "GEQ", "AND", "OR", "ASSIGN", "LT", "GT", "PLUS",
-  "MINUS", "MUL", "DIV", "NOT", "LPAREN", "RPAREN", "LBRACE", "RBRACE",
-  "COMMA", "SEMICOLON", "$accept", "program", "statement_list",
-  "statement", "variable_declaration", "assignment", "if_statement",
-  "for_init", "for_loop", "function_declaration", "function_call",
+  "\"end of file\"", "error", "\"invalid token\"", "UNKNOWN",
+  "IDENTIFIER", "NUMBER", "STRING", "LET", "FUNCTION", "IF", "ELSE", "FOR",
+  "TAKE", "PUBLISH", "EQ", "NEQ", "LEQ", "GEQ", "AND", "OR", "ASSIGN",
+  "LT", "GT", "PLUS", "MINUS", "MUL", "DIV", "NOT", "LPAREN", "RPAREN",
+  "LBRACE", "RBRACE", "COMMA", "SEMICOLON", "$accept", "program",
+  "top_level_list", "statement_list", "statement", "variable_declaration",
+  "assignment", "if_statement", "for_init", "for_loop",
+  "function_declaration", "function_scope", "function_call",
   "input_statement", "publish_statement", "identifier_list",
   "argument_list", "expression", "logical_or", "logical_and", "equality",
-  "comparison", "term", "factor", "unary", "primary", 0
+  "comparison", "term", "factor", "unary", "primary", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-36)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+#define YYTABLE_NINF (-3)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
 {
-       0,    34,    35,    36,    36,    37,    37,    37,    37,    37,
-      37,    37,    37,    38,    39,    40,    40,    41,    41,    42,
-      43,    43,    44,    44,    45,    46,    47,    47,    48,    48,
-      49,    50,    50,    51,    51,    52,    52,    52,    53,    53,
-      53,    53,    53,    54,    54,    54,    55,    55,    55,    56,
-      56,    56,    57,    57,    57,    57,    57
+      87,   -26,     6,     9,    13,    -5,    11,    26,    18,    35,
+     139,   -36,    28,    38,   -36,   -36,   -36,    44,    60,    64,
+     -36,    52,   109,    39,    73,    52,    59,   -36,    52,   -36,
+     -36,   -36,   -36,   -36,   -36,   -36,    78,   -36,   -36,    52,
+      52,    52,   -36,   -36,    84,    90,    75,   137,   118,   130,
+     -36,   -36,   -36,    99,   -36,    52,   -36,    89,    96,   -36,
+     -36,    97,    91,   -36,   -36,   106,    52,    52,    52,    52,
+      52,    52,    52,    52,    52,    52,    52,    52,   -36,    52,
+     -36,    21,   119,    52,   -36,   -36,    90,    75,   137,   137,
+     118,   118,   118,   118,   130,   130,   -36,   -36,   -36,   -36,
+     127,   100,    87,   131,    87,   135,   162,     7,   -36,   163,
+      20,    87,   -36,   158,   -36,   140,   -36,    36,   141,   142,
+     -36,    87,    87,    61,    74,   -36,   -36
 };
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       0,     2,     1,     1,     2,     2,     2,     1,     1,     1,
-       2,     2,     2,     4,     3,     7,    11,     1,     1,    11,
-       8,     7,     4,     3,     2,     4,     1,     3,     1,     3,
-       1,     1,     3,     1,     3,     1,     3,     3,     1,     3,
-       3,     3,     3,     1,     3,     3,     1,     3,     3,     2,
-       2,     1,     1,     1,     1,     1,     3
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     3,     0,     0,     9,    10,    11,     0,     0,     0,
+      15,     0,     0,     0,     0,     0,     0,    28,     0,     1,
+       4,     7,     8,    12,    13,    14,    58,    56,    57,     0,
+       0,     0,    59,    17,    34,    35,    37,    39,    42,    47,
+      50,    55,    27,     0,    32,     0,    25,     0,     0,    20,
+      21,     0,     0,    54,    53,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    26,     0,
+      16,     0,     0,     0,    29,    60,    36,    38,    40,    41,
+      44,    46,    43,    45,    48,    49,    51,    52,    33,    30,
+       0,     0,     0,     0,     0,     0,     0,     0,     5,     0,
+       0,     0,    31,    18,     6,     0,    24,     0,     0,     0,
+      23,     0,     0,     0,     0,    19,    22
 };
 
-/* YYDEFACT[STATE-NAME] -- Default rule to reduce with in state
-   STATE-NUM when YYTABLE doesn't specify something else to do.  Zero
-   means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
 {
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     2,
-       3,     0,     0,     7,     8,     9,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,    24,     0,     1,     4,     5,
-       6,    10,    11,    12,    54,    52,    53,     0,     0,     0,
-      55,    14,    30,    31,    33,    35,    38,    43,    46,    51,
-      23,     0,    28,     0,     0,     0,     0,    17,    18,     0,
-       0,    50,    49,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,    22,     0,    13,    26,
-       0,     0,     0,     0,    25,    56,    32,    34,    36,    37,
-      40,    42,    39,    41,    44,    45,    47,    48,    29,     0,
-       0,     0,     0,     0,     0,     0,    27,     0,     0,    21,
-       0,    15,     0,    20,     0,     0,     0,     0,     0,     0,
-      16,    19
+     -36,   -36,   -36,    23,     2,   144,   -25,   -36,   -36,   -36,
+     -36,   -36,     0,   -36,   -36,   -36,   -36,   -19,   -36,   107,
+     108,    92,   -18,    88,   -35,   -36
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     8,     9,    10,    11,    12,    13,    59,    14,    15,
-      40,    17,    18,    81,    51,    41,    42,    43,    44,    45,
-      46,    47,    48,    49
+       0,     9,    10,   107,   108,    12,    13,    14,    61,    15,
+      16,    81,    42,    18,    19,   101,    53,    43,    44,    45,
+      46,    47,    48,    49,    50,    51
 };
 
-/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-   STATE-NUM.  */
-#define YYPACT_NINF -38
-static const yytype_int16 yypact[] =
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
 {
-     119,    -6,    -1,    14,    -8,     8,    23,    10,    45,   119,
-     -38,    19,    25,   -38,   -38,   -38,    37,    44,    59,   116,
-      35,    27,    28,   116,    53,   -38,   116,   -38,   -38,   -38,
-     -38,   -38,   -38,   -38,    68,   -38,   -38,   116,   116,   116,
-     -38,   -38,   110,    83,    73,   117,    58,    89,   -38,   -38,
-     -38,    36,   -38,   116,    15,    79,   121,   -38,   -38,   104,
-     113,   -38,   -38,   118,   116,   116,   116,   116,   116,   116,
-     116,   116,   116,   116,   116,   116,   -38,   116,   -38,   -38,
-     115,    77,   120,   116,   -38,   -38,    83,    73,   117,   117,
-      58,    58,    58,    58,    89,    89,   -38,   -38,   -38,   119,
-     122,   142,   119,   123,     4,   119,   -38,    17,   144,   -38,
-      42,   139,   124,   -38,   125,   127,   119,   119,    67,    82,
-     -38,   -38
+      17,    60,    11,    54,    63,    64,    57,    20,     1,    62,
+      17,     2,    30,    23,     3,     4,     5,    24,     6,     7,
+       8,     1,    65,    25,     2,    99,    21,     3,     4,     5,
+      27,     6,     7,     8,    22,    29,    80,     1,   113,    26,
+       2,    96,    97,     3,     4,     5,    28,     6,     7,     8,
+     100,   116,    90,    91,    92,    93,    36,    37,    38,    55,
+      98,    31,     1,    58,   103,     2,     3,   120,     3,     4,
+       5,    32,     6,     7,     8,     1,    39,    33,     2,    40,
+      41,     3,     4,     5,   115,     6,     7,     8,     1,    68,
+      69,     2,   125,    34,     3,     4,     5,    35,     6,     7,
+       8,    56,    17,    66,    17,   126,    22,    17,    67,   114,
+      17,    17,   114,    36,    37,    38,    21,    17,    82,   114,
+      84,    17,    17,    17,    17,   114,   114,   110,    78,   105,
+      83,    79,   106,    39,   117,    85,    40,    41,    52,    -2,
+       1,    74,    75,     2,   123,   124,     3,     4,     5,   102,
+       6,     7,     8,    70,    71,    76,    77,   104,    72,    73,
+      88,    89,    94,    95,   109,   111,   112,    58,   118,   119,
+      59,   121,   122,    86,     0,    87
 };
 
-/* YYPGOTO[NTERM-NUM].  */
-static const yytype_int16 yypgoto[] =
+static const yytype_int8 yycheck[] =
 {
-     -38,   -38,   -33,    -7,   130,   -23,   -38,   -38,   -38,   -38,
-       0,   -38,   -38,   -38,   -38,   -16,   -38,    87,    93,    69,
-     -37,    52,   -32,   -38
+       0,    26,     0,    22,    39,    40,    25,    33,     1,    28,
+      10,     4,    10,     4,     7,     8,     9,     4,    11,    12,
+      13,     1,    41,    28,     4,     4,    20,     7,     8,     9,
+       4,    11,    12,    13,    28,     0,    55,     1,    31,    28,
+       4,    76,    77,     7,     8,     9,    28,    11,    12,    13,
+      29,    31,    70,    71,    72,    73,     4,     5,     6,    20,
+      79,    33,     1,     4,    83,     4,     7,    31,     7,     8,
+       9,    33,    11,    12,    13,     1,    24,    33,     4,    27,
+      28,     7,     8,     9,   109,    11,    12,    13,     1,    14,
+      15,     4,    31,    33,     7,     8,     9,    33,    11,    12,
+      13,    28,   102,    19,   104,    31,    28,   107,    18,   107,
+     110,   111,   110,     4,     5,     6,    20,   117,    29,   117,
+      29,   121,   122,   123,   124,   123,   124,   104,    29,    29,
+      33,    32,    32,    24,   111,    29,    27,    28,    29,     0,
+       1,    23,    24,     4,   121,   122,     7,     8,     9,    30,
+      11,    12,    13,    16,    17,    25,    26,    30,    21,    22,
+      68,    69,    74,    75,    33,    30,     4,     4,    10,    29,
+      26,    30,    30,    66,    -1,    67
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
-   number is the opposite.  If zero, do what YYDEFACT says.
-   If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -1
-static const yytype_uint8 yytable[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-      16,    58,    28,    21,    52,    61,    62,    55,     1,    16,
-      60,     2,     3,     4,    19,     5,     6,     7,    22,    79,
-      23,     1,    20,    63,     2,     3,     4,    25,     5,     6,
-       7,    90,    91,    92,    93,   109,    24,    78,    26,    34,
-      35,    36,    96,    97,    80,    27,     1,    53,   111,     2,
-       3,     4,    29,     5,     6,     7,    54,    56,    30,    37,
-       2,    98,    38,    39,    50,    76,   104,   103,    77,   107,
-      31,     1,   110,   113,     2,     3,     4,    32,     5,     6,
-       7,    72,    73,   118,   119,   112,     1,    66,    67,     2,
-       3,     4,    33,     5,     6,     7,    20,    28,   120,    16,
-      28,    65,    16,    28,    16,    16,   100,    16,    82,   101,
-      16,    28,    28,   121,    74,    75,    16,    16,    16,    16,
-      34,    35,    36,     1,    94,    95,     2,     3,     4,    64,
-       5,     6,     7,    68,    69,    88,    89,    83,    70,    71,
-      37,    19,    84,    38,    39,    99,   106,    85,    56,   114,
-     102,    86,   105,   115,    57,   116,   108,   117,    87
+       0,     1,     4,     7,     8,     9,    11,    12,    13,    35,
+      36,    38,    39,    40,    41,    43,    44,    46,    47,    48,
+      33,    20,    28,     4,     4,    28,    28,     4,    28,     0,
+      38,    33,    33,    33,    33,    33,     4,     5,     6,    24,
+      27,    28,    46,    51,    52,    53,    54,    55,    56,    57,
+      58,    59,    29,    50,    51,    20,    28,    51,     4,    39,
+      40,    42,    51,    58,    58,    51,    19,    18,    14,    15,
+      16,    17,    21,    22,    23,    24,    25,    26,    29,    32,
+      51,    45,    29,    33,    29,    29,    53,    54,    55,    55,
+      56,    56,    56,    56,    57,    57,    58,    58,    51,     4,
+      29,    49,    30,    51,    30,    29,    32,    37,    38,    33,
+      37,    30,     4,    31,    38,    40,    31,    37,    10,    29,
+      31,    30,    30,    37,    37,    31,    31
 };
 
-static const yytype_uint8 yycheck[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-       0,    24,     9,     4,    20,    37,    38,    23,     4,     9,
-      26,     7,     8,     9,    20,    11,    12,    13,     4,     4,
-      28,     4,    28,    39,     7,     8,     9,     4,    11,    12,
-      13,    68,    69,    70,    71,    31,    28,    53,    28,     4,
-       5,     6,    74,    75,    29,     0,     4,    20,    31,     7,
-       8,     9,    33,    11,    12,    13,    28,     4,    33,    24,
-       7,    77,    27,    28,    29,    29,    99,    83,    32,   102,
-      33,     4,   105,    31,     7,     8,     9,    33,    11,    12,
-      13,    23,    24,   116,   117,   108,     4,    14,    15,     7,
-       8,     9,    33,    11,    12,    13,    28,   104,    31,    99,
-     107,    18,   102,   110,   104,   105,    29,   107,    29,    32,
-     110,   118,   119,    31,    25,    26,   116,   117,   118,   119,
-       4,     5,     6,     4,    72,    73,     7,     8,     9,    19,
-      11,    12,    13,    16,    17,    66,    67,    33,    21,    22,
-      24,    20,    29,    27,    28,    30,     4,    29,     4,    10,
-      30,    64,    30,    29,    24,    30,    33,    30,    65
+       0,    34,    35,    36,    36,    37,    37,    38,    38,    38,
+      38,    38,    38,    38,    38,    38,    39,    40,    41,    41,
+      42,    42,    43,    44,    44,    45,    46,    46,    47,    48,
+      49,    49,    50,    50,    51,    52,    52,    53,    53,    54,
+      54,    54,    55,    55,    55,    55,    55,    56,    56,    56,
+      57,    57,    57,    58,    58,    58,    59,    59,    59,    59,
+      59
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
-       0,     4,     7,     8,     9,    11,    12,    13,    35,    36,
-      37,    38,    39,    40,    42,    43,    44,    45,    46,    20,
-      28,     4,     4,    28,    28,     4,    28,     0,    37,    33,
-      33,    33,    33,    33,     4,     5,     6,    24,    27,    28,
-      44,    49,    50,    51,    52,    53,    54,    55,    56,    57,
-      29,    48,    49,    20,    28,    49,     4,    38,    39,    41,
-      49,    56,    56,    49,    19,    18,    14,    15,    16,    17,
-      21,    22,    23,    24,    25,    26,    29,    32,    49,     4,
-      29,    47,    29,    33,    29,    29,    51,    52,    53,    53,
-      54,    54,    54,    54,    55,    55,    56,    56,    49,    30,
-      29,    32,    30,    49,    36,    30,     4,    36,    33,    31,
-      36,    31,    39,    31,    10,    29,    30,    30,    36,    36,
-      31,    31
+       0,     2,     1,     1,     2,     1,     2,     2,     2,     1,
+       1,     1,     2,     2,     2,     2,     4,     3,     7,    11,
+       1,     1,    11,     9,     8,     0,     4,     3,     2,     4,
+       1,     3,     1,     3,     1,     1,     3,     1,     3,     1,
+       3,     3,     1,     3,     3,     3,     3,     1,     3,     3,
+       1,     3,     3,     2,     2,     1,     1,     1,     1,     1,
+       3
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
 
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
+enum { YYENOMEM = -2 };
 
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  */
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
-#define YYFAIL		goto yyerrlab
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)					\
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    {								\
-      yychar = (Token);						\
-      yylval = (Value);						\
-      yytoken = YYTRANSLATE (yychar);				\
-      YYPOPSTACK (1);						\
-      goto yybackup;						\
-    }								\
-  else								\
-    {								\
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
-   If N is 0, then set CURRENT to the empty location which ends
-   the previous symbol: RHS[0] (always defined).  */
-
-#define YYRHSLOC(Rhs, K) ((Rhs)[K])
-#ifndef YYLLOC_DEFAULT
-# define YYLLOC_DEFAULT(Current, Rhs, N)				\
-    do									\
-      if (YYID (N))                                                    \
-	{								\
-	  (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;	\
-	  (Current).first_column = YYRHSLOC (Rhs, 1).first_column;	\
-	  (Current).last_line    = YYRHSLOC (Rhs, N).last_line;		\
-	  (Current).last_column  = YYRHSLOC (Rhs, N).last_column;	\
-	}								\
-      else								\
-	{								\
-	  (Current).first_line   = (Current).last_line   =		\
-	    YYRHSLOC (Rhs, 0).last_line;				\
-	  (Current).first_column = (Current).last_column =		\
-	    YYRHSLOC (Rhs, 0).last_column;				\
-	}								\
-    while (YYID (0))
-#endif
-
-
-/* YY_LOCATION_PRINT -- Print the location on the stream.
-   This macro was not mandated originally: define only if we know
-   we won't break user code: when these are the locations we know.  */
-
-#ifndef YY_LOCATION_PRINT
-# if YYLTYPE_IS_TRIVIAL
-#  define YY_LOCATION_PRINT(File, Loc)			\
-     fprintf (File, "%d.%d-%d.%d",			\
-	      (Loc).first_line, (Loc).first_column,	\
-	      (Loc).last_line,  (Loc).last_column)
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (ctx, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
-
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
-
 /* Enable debugging if requested.  */
 #if YYDEBUG
 
@@ -765,80 +782,59 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, ctx); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, CompilerContext* ctx)
 {
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (ctx);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
 static void
-yy_symbol_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, CompilerContext* ctx)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, ctx);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -846,16 +842,8 @@ yy_symbol_print (yyoutput, yytype, yyvaluep)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
-#else
 static void
-yy_stack_print (yybottom, yytop)
-    yytype_int16 *yybottom;
-    yytype_int16 *yytop;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -866,63 +854,56 @@ yy_stack_print (yybottom, yytop)
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yyrule)
-    YYSTYPE *yyvsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, CompilerContext* ctx)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       );
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], ctx);
       YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, ctx); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -936,343 +917,179 @@ int yydebug;
 #ifndef YYMAXDEPTH
 # define YYMAXDEPTH 10000
 #endif
+/* Parser data structure.  */
+struct yypstate
+  {
+    /* Number of syntax errors so far.  */
+    int yynerrs;
 
-
-
-#if YYERROR_VERBOSE
+    yy_state_fast_t yystate;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus;
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize;
 
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss;
+    yy_state_t *yyssp;
 
-  return yyd - 1;
-}
-#  endif
-# endif
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs;
+    YYSTYPE *yyvsp;
+    /* Whether this instance has not started parsing yet.
+     * If 2, it corresponds to a finished parsing.  */
+    int yynew;
+  };
 
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
 
-  if (! yyres)
-    return yystrlen (yystr);
 
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
 
-/* Copy into YYRESULT an error message about the unexpected token
-   YYCHAR while in state YYSTATE.  Return the number of bytes copied,
-   including the terminating null byte.  If YYRESULT is null, do not
-   copy anything; just return the number of bytes that would be
-   copied.  As a special case, return 0 if an ordinary "syntax error"
-   message will do.  Return YYSIZE_MAXIMUM if overflow occurs during
-   size calculation.  */
-static YYSIZE_T
-yysyntax_error (char *yyresult, int yystate, int yychar)
-{
-  int yyn = yypact[yystate];
 
-  if (! (YYPACT_NINF < yyn && yyn <= YYLAST))
-    return 0;
-  else
-    {
-      int yytype = YYTRANSLATE (yychar);
-      YYSIZE_T yysize0 = yytnamerr (0, yytname[yytype]);
-      YYSIZE_T yysize = yysize0;
-      YYSIZE_T yysize1;
-      int yysize_overflow = 0;
-      enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-      char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-      int yyx;
-
-# if 0
-      /* This is so xgettext sees the translatable formats that are
-	 constructed on the fly.  */
-      YY_("syntax error, unexpected %s");
-      YY_("syntax error, unexpected %s, expecting %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s");
-# endif
-      char *yyfmt;
-      char const *yyf;
-      static char const yyunexpected[] = "syntax error, unexpected %s";
-      static char const yyexpecting[] = ", expecting %s";
-      static char const yyor[] = " or %s";
-      char yyformat[sizeof yyunexpected
-		    + sizeof yyexpecting - 1
-		    + ((YYERROR_VERBOSE_ARGS_MAXIMUM - 2)
-		       * (sizeof yyor - 1))];
-      char const *yyprefix = yyexpecting;
-
-      /* Start YYX at -YYN if negative to avoid negative indexes in
-	 YYCHECK.  */
-      int yyxbegin = yyn < 0 ? -yyn : 0;
-
-      /* Stay within bounds of both yycheck and yytname.  */
-      int yychecklim = YYLAST - yyn + 1;
-      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-      int yycount = 1;
-
-      yyarg[0] = yytname[yytype];
-      yyfmt = yystpcpy (yyformat, yyunexpected);
-
-      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-	if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR)
-	  {
-	    if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-	      {
-		yycount = 1;
-		yysize = yysize0;
-		yyformat[sizeof yyunexpected - 1] = '\0';
-		break;
-	      }
-	    yyarg[yycount++] = yytname[yyx];
-	    yysize1 = yysize + yytnamerr (0, yytname[yyx]);
-	    yysize_overflow |= (yysize1 < yysize);
-	    yysize = yysize1;
-	    yyfmt = yystpcpy (yyfmt, yyprefix);
-	    yyprefix = yyor;
-	  }
-
-      yyf = YY_(yyformat);
-      yysize1 = yysize + yystrlen (yyf);
-      yysize_overflow |= (yysize1 < yysize);
-      yysize = yysize1;
-
-      if (yysize_overflow)
-	return YYSIZE_MAXIMUM;
-
-      if (yyresult)
-	{
-	  /* Avoid sprintf, as that infringes on the user's name space.
-	     Don't have undefined behavior even if the translation
-	     produced a string with the wrong number of "%s"s.  */
-	  char *yyp = yyresult;
-	  int yyi = 0;
-	  while ((*yyp = *yyf) != '\0')
-	    {
-	      if (*yyp == '%' && yyf[1] == 's' && yyi < yycount)
-		{
-		  yyp += yytnamerr (yyp, yyarg[yyi++]);
-		  yyf += 2;
-		}
-	      else
-		{
-		  yyp++;
-		  yyf++;
-		}
-	    }
-	}
-      return yysize;
-    }
-}
-#endif /* YYERROR_VERBOSE */
-
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
-#else
 static void
-yydestruct (yymsg, yytype, yyvaluep)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, CompilerContext* ctx)
 {
-  YYUSE (yyvaluep);
-
+  YY_USE (yyvaluep);
+  YY_USE (ctx);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
-
-  switch (yytype)
-    {
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
-/* Prevent warnings from -Wmissing-prototypes.  */
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
 
 
-/* The lookahead symbol.  */
-int yychar;
 
-/* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
 
-/* Number of syntax errors so far.  */
-int yynerrs;
+int
+yyparse (CompilerContext* ctx)
+{
+  yypstate *yyps = yypstate_new ();
+  if (!yyps)
+    {
+      yyerror (ctx, YY_("memory exhausted"));
+      return 2;
+    }
+  int yystatus = yypull_parse (yyps, ctx);
+  yypstate_delete (yyps);
+  return yystatus;
+}
 
+int
+yypull_parse (yypstate *yyps, CompilerContext* ctx)
+{
+  YY_ASSERT (yyps);
+  int yystatus;
+  do {
+    YYSTYPE yylval;
+    int yychar = yylex (&yylval, ctx);
+    yystatus = yypush_parse (yyps, yychar, &yylval, ctx);
+  } while (yystatus == YYPUSH_MORE);
+  return yystatus;
+}
 
+#define yynerrs yyps->yynerrs
+#define yystate yyps->yystate
+#define yyerrstatus yyps->yyerrstatus
+#define yyssa yyps->yyssa
+#define yyss yyps->yyss
+#define yyssp yyps->yyssp
+#define yyvsa yyps->yyvsa
+#define yyvs yyps->yyvs
+#define yyvsp yyps->yyvsp
+#define yystacksize yyps->yystacksize
+
+/* Initialize the parser data structure.  */
+static void
+yypstate_clear (yypstate *yyps)
+{
+  yynerrs = 0;
+  yystate = 0;
+  yyerrstatus = 0;
 
-/*-------------------------.
-| yyparse or yypush_parse.  |
-`-------------------------*/
+  yyssp = yyss;
+  yyvsp = yyvs;
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void)
-#else
-int
-yyparse ()
+  /* Initialize the state stack, in case yypcontext_expected_tokens is
+     called before the first call to yyparse. */
+  *yyssp = 0;
+  yyps->yynew = 1;
+}
 
-#endif
-#endif
+/* Initialize the parser data structure.  */
+yypstate *
+yypstate_new (void)
 {
+  yypstate *yyps;
+  yyps = YY_CAST (yypstate *, YYMALLOC (sizeof *yyps));
+  if (!yyps)
+    return YY_NULLPTR;
+  yystacksize = YYINITDEPTH;
+  yyss = yyssa;
+  yyvs = yyvsa;
+  yypstate_clear (yyps);
+  return yyps;
+}
 
+void
+yypstate_delete (yypstate *yyps)
+{
+  if (yyps)
+    {
+#ifndef yyoverflow
+      /* If the stack was reallocated but the parse did not complete, then the
+         stack still needs to be freed.  */
+      if (yyss != yyssa)
+        YYSTACK_FREE (yyss);
+#endif
+      YYFREE (yyps);
+    }
+}
 
-    int yystate;
-    /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
 
-    /* The stacks and their tools:
-       `yyss': related to states.
-       `yyvs': related to semantic values.
 
-       Refer to the stacks thru separate pointers, to allow yyoverflow
-       to reallocate them elsewhere.  */
+/*---------------.
+| yypush_parse.  |
+`---------------*/
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+int
+yypush_parse (yypstate *yyps,
+              int yypushed_char, YYSTYPE const *yypushed_val, CompilerContext* ctx)
+{
+/* Lookahead token kind.  */
+int yychar;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
 
-    YYSIZE_T yystacksize;
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1280,133 +1097,164 @@ yyparse ()
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yytoken = 0;
-  yyss = yyssa;
-  yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
+  switch (yyps->yynew)
+    {
+    case 0:
+      yyn = yypact[yystate];
+      goto yyread_pushed_token;
+
+    case 2:
+      yypstate_clear (yyps);
+      break;
+
+    default:
+      break;
+    }
 
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
 
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
-  yyssp = yyss;
-  yyvsp = yyvs;
-
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss_alloc, yyss);
-	YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
   /* First try to decide what to do without reference to lookahead token.  */
   yyn = yypact[yystate];
-  if (yyn == YYPACT_NINF)
+  if (yypact_value_is_default (yyn))
     goto yydefault;
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      if (!yyps->yynew)
+        {
+          YYDPRINTF ((stderr, "Return for a new token:\n"));
+          yyresult = YYPUSH_MORE;
+          goto yypushreturn;
+        }
+      yyps->yynew = 0;
+yyread_pushed_token:
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yypushed_char;
+      if (yypushed_val)
+        yylval = *yypushed_val;
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1421,8 +1269,8 @@ yybackup:
   yyn = yytable[yyn];
   if (yyn <= 0)
     {
-      if (yyn == 0 || yyn == YYTABLE_NINF)
-	goto yyerrlab;
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
       yyn = -yyn;
       goto yyreduce;
     }
@@ -1434,13 +1282,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1455,14 +1303,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1475,509 +1323,449 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-
-/* Line 1455 of yacc.c  */
-#line 41 "src/parser.y"
-    {
-        root = (yyvsp[(1) - (1)].ast);
-        ast_root = (yyvsp[(1) - (1)].ast);  // Set ast_root to the same value as root
-        (yyval.ast) = (yyvsp[(1) - (1)].ast);  // Return the root node
-    ;}
-    break;
-
-  case 3:
-
-/* Line 1455 of yacc.c  */
-#line 49 "src/parser.y"
-    {
-        // If this is a variable declaration, add it to the front of the list
-        if ((yyvsp[(1) - (1)].ast)->type == AST_VAR_DECL) {
-            (yyval.ast) = create_stmt_list_node((yyvsp[(1) - (1)].ast), NULL, line_num);
-        } else {
-            // For other statements, add them to the end
-            (yyval.ast) = create_stmt_list_node((yyvsp[(1) - (1)].ast), NULL, line_num);
-        }
-    ;}
-    break;
-
-  case 4:
-
-/* Line 1455 of yacc.c  */
-#line 58 "src/parser.y"
-    {
-        if ((yyvsp[(2) - (2)].ast)->type == AST_VAR_DECL) {
-            // For variable declarations, add to the front
-            (yyval.ast) = create_stmt_list_node((yyvsp[(2) - (2)].ast), (yyvsp[(1) - (2)].ast), line_num);
-        } else {
-            // For other statements, add to the end
-            ASTNode* current = (yyvsp[(1) - (2)].ast);
-            while (current->stmt_list.next != NULL) {
-                current = current->stmt_list.next;
-            }
-            current->stmt_list.next = create_stmt_list_node((yyvsp[(2) - (2)].ast), NULL, line_num);
-            (yyval.ast) = (yyvsp[(1) - (2)].ast);
-        }
-    ;}
-    break;
-
-  case 5:
-
-/* Line 1455 of yacc.c  */
-#line 75 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (2)].ast); ;}
+  case 2: /* program: top_level_list  */
+#line 59 "src/parser.y"
+                     {
+        ctx->root = (yyvsp[0].list).head;
+        (yyval.ast) = (yyvsp[0].list).head;  // Return the root node
+    }
+#line 1333 "src/parser.tab.c"
     break;
 
-  case 6:
-
-/* Line 1455 of yacc.c  */
-#line 76 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (2)].ast); ;}
+  case 3: /* top_level_list: statement  */
+#line 67 "src/parser.y"
+                {
+        (yyval.list).head = (yyval.list).tail = AST_NONE;
+        if (!add_top_level_statement(ctx, &(yyval.list), (yyvsp[0].ast))) YYABORT;
+    }
+#line 1342 "src/parser.tab.c"
     break;
 
-  case 7:
-
-/* Line 1455 of yacc.c  */
-#line 77 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+  case 4: /* top_level_list: top_level_list statement  */
+#line 71 "src/parser.y"
+                               {
+        (yyval.list) = (yyvsp[-1].list);
+        if (!add_top_level_statement(ctx, &(yyval.list), (yyvsp[0].ast))) YYABORT;
+    }
+#line 1351 "src/parser.tab.c"
     break;
 
-  case 8:
-
-/* Line 1455 of yacc.c  */
+  case 5: /* statement_list: statement  */
 #line 78 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+                {
+        (yyval.list).head = (yyval.list).tail = AST_NONE;
+        append_statement(ctx, &(yyval.list), (yyvsp[0].ast));
+    }
+#line 1360 "src/parser.tab.c"
     break;
 
-  case 9:
-
-/* Line 1455 of yacc.c  */
-#line 79 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+  case 6: /* statement_list: statement_list statement  */
+#line 82 "src/parser.y"
+                               {
+        (yyval.list) = (yyvsp[-1].list);
+        append_statement(ctx, &(yyval.list), (yyvsp[0].ast));
+    }
+#line 1369 "src/parser.tab.c"
     break;
 
-  case 10:
-
-/* Line 1455 of yacc.c  */
-#line 80 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (2)].ast); ;}
+  case 7: /* statement: variable_declaration SEMICOLON  */
+#line 89 "src/parser.y"
+                                       { (yyval.ast) = (yyvsp[-1].ast); }
+#line 1375 "src/parser.tab.c"
     break;
 
-  case 11:
-
-/* Line 1455 of yacc.c  */
-#line 81 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (2)].ast); ;}
+  case 8: /* statement: assignment SEMICOLON  */
+#line 90 "src/parser.y"
+                                       { (yyval.ast) = (yyvsp[-1].ast); }
+#line 1381 "src/parser.tab.c"
     break;
 
-  case 12:
-
-/* Line 1455 of yacc.c  */
-#line 82 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (2)].ast); ;}
+  case 9: /* statement: if_statement  */
+#line 91 "src/parser.y"
+                                       { (yyval.ast) = (yyvsp[0].ast); }
+#line 1387 "src/parser.tab.c"
     break;
 
-  case 13:
-
-/* Line 1455 of yacc.c  */
-#line 86 "src/parser.y"
-    { (yyval.ast) = create_var_decl_node((yyvsp[(2) - (4)].string_val), (yyvsp[(4) - (4)].ast), line_num); ;}
+  case 10: /* statement: for_loop  */
+#line 92 "src/parser.y"
+                                       { (yyval.ast) = (yyvsp[0].ast); }
+#line 1393 "src/parser.tab.c"
     break;
 
-  case 14:
-
-/* Line 1455 of yacc.c  */
-#line 90 "src/parser.y"
-    { (yyval.ast) = create_assignment_node((yyvsp[(1) - (3)].string_val), (yyvsp[(3) - (3)].ast), line_num); ;}
+  case 11: /* statement: function_declaration  */
+#line 93 "src/parser.y"
+                                       { (yyval.ast) = (yyvsp[0].ast); }
+#line 1399 "src/parser.tab.c"
     break;
 
-  case 15:
+  case 12: /* statement: function_call SEMICOLON  */
+#line 94 "src/parser.y"
+                                       { (yyval.ast) = (yyvsp[-1].ast); }
+#line 1405 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
+  case 13: /* statement: input_statement SEMICOLON  */
 #line 95 "src/parser.y"
-    { (yyval.ast) = create_if_node((yyvsp[(3) - (7)].ast), (yyvsp[(6) - (7)].ast), NULL, line_num); ;}
+                                       { (yyval.ast) = (yyvsp[-1].ast); }
+#line 1411 "src/parser.tab.c"
     break;
 
-  case 16:
-
-/* Line 1455 of yacc.c  */
-#line 97 "src/parser.y"
-    { (yyval.ast) = create_if_node((yyvsp[(3) - (11)].ast), (yyvsp[(6) - (11)].ast), (yyvsp[(10) - (11)].ast), line_num); ;}
+  case 14: /* statement: publish_statement SEMICOLON  */
+#line 96 "src/parser.y"
+                                       { (yyval.ast) = (yyvsp[-1].ast); }
+#line 1417 "src/parser.tab.c"
     break;
 
-  case 17:
-
-/* Line 1455 of yacc.c  */
-#line 101 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+  case 15: /* statement: error SEMICOLON  */
+#line 99 "src/parser.y"
+                                       { (yyval.ast) = AST_NONE; yyerrok; }
+#line 1423 "src/parser.tab.c"
     break;
 
-  case 18:
-
-/* Line 1455 of yacc.c  */
-#line 102 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+  case 16: /* variable_declaration: LET IDENTIFIER ASSIGN expression  */
+#line 103 "src/parser.y"
+                                       { (yyval.ast) = create_var_decl_node(&ctx->ast, (yyvsp[-2].string_val), (yyvsp[0].ast), ctx->line_num); }
+#line 1429 "src/parser.tab.c"
     break;
 
-  case 19:
-
-/* Line 1455 of yacc.c  */
+  case 17: /* assignment: IDENTIFIER ASSIGN expression  */
 #line 107 "src/parser.y"
-    { (yyval.ast) = create_for_node((yyvsp[(3) - (11)].ast), (yyvsp[(5) - (11)].ast), (yyvsp[(7) - (11)].ast), (yyvsp[(10) - (11)].ast), line_num); ;}
+                                       { (yyval.ast) = create_assignment_node(&ctx->ast, (yyvsp[-2].string_val), (yyvsp[0].ast), ctx->line_num); }
+#line 1435 "src/parser.tab.c"
     break;
 
-  case 20:
-
-/* Line 1455 of yacc.c  */
+  case 18: /* if_statement: IF LPAREN expression RPAREN LBRACE statement_list RBRACE  */
 #line 112 "src/parser.y"
-    { (yyval.ast) = create_func_decl_node((yyvsp[(2) - (8)].string_val), (yyvsp[(4) - (8)].ast), (yyvsp[(7) - (8)].ast), line_num); ;}
+        { (yyval.ast) = create_if_node(&ctx->ast, (yyvsp[-4].ast), (yyvsp[-1].list).head, AST_NONE, ctx->line_num); }
+#line 1441 "src/parser.tab.c"
     break;
 
-  case 21:
-
-/* Line 1455 of yacc.c  */
+  case 19: /* if_statement: IF LPAREN expression RPAREN LBRACE statement_list RBRACE ELSE LBRACE statement_list RBRACE  */
 #line 114 "src/parser.y"
-    { (yyval.ast) = create_func_decl_node((yyvsp[(2) - (7)].string_val), NULL, (yyvsp[(6) - (7)].ast), line_num); ;}
+        { (yyval.ast) = create_if_node(&ctx->ast, (yyvsp[-8].ast), (yyvsp[-5].list).head, (yyvsp[-1].list).head, ctx->line_num); }
+#line 1447 "src/parser.tab.c"
     break;
 
-  case 22:
-
-/* Line 1455 of yacc.c  */
-#line 119 "src/parser.y"
-    { (yyval.ast) = create_func_call_node((yyvsp[(1) - (4)].string_val), (yyvsp[(3) - (4)].ast), line_num); ;}
+  case 20: /* for_init: variable_declaration  */
+#line 118 "src/parser.y"
+                           { (yyval.ast) = (yyvsp[0].ast); }
+#line 1453 "src/parser.tab.c"
     break;
 
-  case 23:
-
-/* Line 1455 of yacc.c  */
-#line 121 "src/parser.y"
-    { (yyval.ast) = create_func_call_node((yyvsp[(1) - (3)].string_val), NULL, line_num); ;}
+  case 21: /* for_init: assignment  */
+#line 119 "src/parser.y"
+                 { (yyval.ast) = (yyvsp[0].ast); }
+#line 1459 "src/parser.tab.c"
     break;
 
-  case 24:
-
-/* Line 1455 of yacc.c  */
-#line 125 "src/parser.y"
-    { (yyval.ast) = create_input_node((yyvsp[(2) - (2)].string_val), line_num); ;}
+  case 22: /* for_loop: FOR LPAREN for_init SEMICOLON expression SEMICOLON assignment RPAREN LBRACE statement_list RBRACE  */
+#line 124 "src/parser.y"
+        { (yyval.ast) = create_for_node(&ctx->ast, (yyvsp[-8].ast), (yyvsp[-6].ast), (yyvsp[-4].ast), (yyvsp[-1].list).head, ctx->line_num); }
+#line 1465 "src/parser.tab.c"
     break;
 
-  case 25:
-
-/* Line 1455 of yacc.c  */
+  case 23: /* function_declaration: FUNCTION IDENTIFIER LPAREN function_scope identifier_list RPAREN LBRACE statement_list RBRACE  */
 #line 129 "src/parser.y"
-    { (yyval.ast) = create_publish_node((yyvsp[(3) - (4)].ast), line_num); ;}
-    break;
-
-  case 26:
-
-/* Line 1455 of yacc.c  */
-#line 133 "src/parser.y"
-    { (yyval.ast) = create_identifier_list((yyvsp[(1) - (1)].string_val), NULL, line_num); ;}
+        {
+            ast_close_scope(&ctx->ast, (yyvsp[-5].scope));
+            (yyval.ast) = create_func_decl_node(&ctx->ast, (yyvsp[-7].string_val), (yyvsp[-4].ast), (yyvsp[-1].list).head, ctx->line_num);
+        }
+#line 1474 "src/parser.tab.c"
     break;
 
-  case 27:
-
-/* Line 1455 of yacc.c  */
+  case 24: /* function_declaration: FUNCTION IDENTIFIER LPAREN function_scope RPAREN LBRACE statement_list RBRACE  */
 #line 134 "src/parser.y"
-    { (yyval.ast) = create_identifier_list((yyvsp[(3) - (3)].string_val), (yyvsp[(1) - (3)].ast), line_num); ;}
-    break;
-
-  case 28:
-
-/* Line 1455 of yacc.c  */
-#line 138 "src/parser.y"
-    { (yyval.ast) = create_expr_list_node((yyvsp[(1) - (1)].ast), NULL, line_num); ;}
+        {
+            ast_close_scope(&ctx->ast, (yyvsp[-4].scope));
+            (yyval.ast) = create_func_decl_node(&ctx->ast, (yyvsp[-6].string_val), AST_NONE, (yyvsp[-1].list).head, ctx->line_num);
+        }
+#line 1483 "src/parser.tab.c"
     break;
 
-  case 29:
-
-/* Line 1455 of yacc.c  */
-#line 139 "src/parser.y"
-    { (yyval.ast) = create_expr_list_node((yyvsp[(3) - (3)].ast), (yyvsp[(1) - (3)].ast), line_num); ;}
+  case 25: /* function_scope: %empty  */
+#line 142 "src/parser.y"
+             { (yyval.scope) = ast_open_scope(&ctx->ast); }
+#line 1489 "src/parser.tab.c"
     break;
 
-  case 30:
-
-/* Line 1455 of yacc.c  */
-#line 143 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
-    break;
-
-  case 31:
-
-/* Line 1455 of yacc.c  */
+  case 26: /* function_call: IDENTIFIER LPAREN argument_list RPAREN  */
 #line 147 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+        { (yyval.ast) = create_func_call_node(&ctx->ast, (yyvsp[-3].string_val), (yyvsp[-1].ast), ctx->line_num); }
+#line 1495 "src/parser.tab.c"
     break;
 
-  case 32:
-
-/* Line 1455 of yacc.c  */
-#line 148 "src/parser.y"
-    { (yyval.ast) = create_binary_node("||", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+  case 27: /* function_call: IDENTIFIER LPAREN RPAREN  */
+#line 149 "src/parser.y"
+        { (yyval.ast) = create_func_call_node(&ctx->ast, (yyvsp[-2].string_val), AST_NONE, ctx->line_num); }
+#line 1501 "src/parser.tab.c"
     break;
 
-  case 33:
-
-/* Line 1455 of yacc.c  */
-#line 152 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
-    break;
-
-  case 34:
-
-/* Line 1455 of yacc.c  */
+  case 28: /* input_statement: TAKE IDENTIFIER  */
 #line 153 "src/parser.y"
-    { (yyval.ast) = create_binary_node("&&", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+                      { (yyval.ast) = create_input_node(&ctx->ast, (yyvsp[0].string_val), ctx->line_num); }
+#line 1507 "src/parser.tab.c"
     break;
 
-  case 35:
-
-/* Line 1455 of yacc.c  */
+  case 29: /* publish_statement: PUBLISH LPAREN expression RPAREN  */
 #line 157 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
-    break;
-
-  case 36:
-
-/* Line 1455 of yacc.c  */
-#line 158 "src/parser.y"
-    { (yyval.ast) = create_binary_node("==", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
-    break;
-
-  case 37:
-
-/* Line 1455 of yacc.c  */
-#line 159 "src/parser.y"
-    { (yyval.ast) = create_binary_node("!=", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+                                       { (yyval.ast) = create_publish_node(&ctx->ast, (yyvsp[-1].ast), ctx->line_num); }
+#line 1513 "src/parser.tab.c"
     break;
 
-  case 38:
-
-/* Line 1455 of yacc.c  */
-#line 163 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+  case 30: /* identifier_list: IDENTIFIER  */
+#line 161 "src/parser.y"
+                                         { (yyval.ast) = create_identifier_list(&ctx->ast, (yyvsp[0].string_val), AST_NONE, ctx->line_num); }
+#line 1519 "src/parser.tab.c"
     break;
 
-  case 39:
-
-/* Line 1455 of yacc.c  */
-#line 164 "src/parser.y"
-    { (yyval.ast) = create_binary_node("<", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+  case 31: /* identifier_list: identifier_list COMMA IDENTIFIER  */
+#line 162 "src/parser.y"
+                                        { (yyval.ast) = create_identifier_list(&ctx->ast, (yyvsp[0].string_val), (yyvsp[-2].ast), ctx->line_num); }
+#line 1525 "src/parser.tab.c"
     break;
 
-  case 40:
-
-/* Line 1455 of yacc.c  */
-#line 165 "src/parser.y"
-    { (yyval.ast) = create_binary_node("<=", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
-    break;
-
-  case 41:
-
-/* Line 1455 of yacc.c  */
+  case 32: /* argument_list: expression  */
 #line 166 "src/parser.y"
-    { (yyval.ast) = create_binary_node(">", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+                                        { (yyval.ast) = create_expr_list_node(&ctx->ast, (yyvsp[0].ast), AST_NONE, ctx->line_num); }
+#line 1531 "src/parser.tab.c"
     break;
 
-  case 42:
-
-/* Line 1455 of yacc.c  */
+  case 33: /* argument_list: argument_list COMMA expression  */
 #line 167 "src/parser.y"
-    { (yyval.ast) = create_binary_node(">=", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+                                        { (yyval.ast) = create_expr_list_node(&ctx->ast, (yyvsp[0].ast), (yyvsp[-2].ast), ctx->line_num); }
+#line 1537 "src/parser.tab.c"
     break;
 
-  case 43:
-
-/* Line 1455 of yacc.c  */
+  case 34: /* expression: logical_or  */
 #line 171 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+                 { (yyval.ast) = (yyvsp[0].ast); }
+#line 1543 "src/parser.tab.c"
     break;
 
-  case 44:
+  case 35: /* logical_or: logical_and  */
+#line 175 "src/parser.y"
+                                        { (yyval.ast) = (yyvsp[0].ast); }
+#line 1549 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 172 "src/parser.y"
-    { (yyval.ast) = create_binary_node("+", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+  case 36: /* logical_or: logical_or OR logical_and  */
+#line 176 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_OR, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1555 "src/parser.tab.c"
     break;
 
-  case 45:
+  case 37: /* logical_and: equality  */
+#line 180 "src/parser.y"
+                                        { (yyval.ast) = (yyvsp[0].ast); }
+#line 1561 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 173 "src/parser.y"
-    { (yyval.ast) = create_binary_node("-", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+  case 38: /* logical_and: logical_and AND equality  */
+#line 181 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_AND, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1567 "src/parser.tab.c"
     break;
 
-  case 46:
+  case 39: /* equality: comparison  */
+#line 185 "src/parser.y"
+                                        { (yyval.ast) = (yyvsp[0].ast); }
+#line 1573 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 177 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+  case 40: /* equality: equality EQ comparison  */
+#line 186 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_EQ, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1579 "src/parser.tab.c"
     break;
 
-  case 47:
+  case 41: /* equality: equality NEQ comparison  */
+#line 187 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_NEQ, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1585 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 178 "src/parser.y"
-    { (yyval.ast) = create_binary_node("*", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+  case 42: /* comparison: term  */
+#line 191 "src/parser.y"
+                                        { (yyval.ast) = (yyvsp[0].ast); }
+#line 1591 "src/parser.tab.c"
     break;
 
-  case 48:
+  case 43: /* comparison: comparison LT term  */
+#line 192 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_LT, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1597 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 179 "src/parser.y"
-    { (yyval.ast) = create_binary_node("/", (yyvsp[(1) - (3)].ast), (yyvsp[(3) - (3)].ast), line_num); ;}
+  case 44: /* comparison: comparison LEQ term  */
+#line 193 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_LEQ, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1603 "src/parser.tab.c"
     break;
 
-  case 49:
+  case 45: /* comparison: comparison GT term  */
+#line 194 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_GT, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1609 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 183 "src/parser.y"
-    { (yyval.ast) = create_unary_node("!", (yyvsp[(2) - (2)].ast), line_num); ;}
+  case 46: /* comparison: comparison GEQ term  */
+#line 195 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_GEQ, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1615 "src/parser.tab.c"
     break;
 
-  case 50:
+  case 47: /* term: factor  */
+#line 199 "src/parser.y"
+                                        { (yyval.ast) = (yyvsp[0].ast); }
+#line 1621 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 184 "src/parser.y"
-    { (yyval.ast) = create_unary_node("-", (yyvsp[(2) - (2)].ast), line_num); ;}
+  case 48: /* term: term PLUS factor  */
+#line 200 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_ADD, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1627 "src/parser.tab.c"
     break;
 
-  case 51:
+  case 49: /* term: term MINUS factor  */
+#line 201 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_SUB, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1633 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 185 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+  case 50: /* factor: unary  */
+#line 205 "src/parser.y"
+                                        { (yyval.ast) = (yyvsp[0].ast); }
+#line 1639 "src/parser.tab.c"
     break;
 
-  case 52:
+  case 51: /* factor: factor MUL unary  */
+#line 206 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_MUL, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1645 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 189 "src/parser.y"
-    { (yyval.ast) = create_number_node((yyvsp[(1) - (1)].int_val), line_num); ;}
+  case 52: /* factor: factor DIV unary  */
+#line 207 "src/parser.y"
+                                        { (yyval.ast) = create_binary_node(&ctx->ast, AST_OP_DIV, (yyvsp[-2].ast), (yyvsp[0].ast), ctx->line_num); }
+#line 1651 "src/parser.tab.c"
     break;
 
-  case 53:
+  case 53: /* unary: NOT unary  */
+#line 211 "src/parser.y"
+                                        { (yyval.ast) = create_unary_node(&ctx->ast, AST_OP_NOT, (yyvsp[0].ast), ctx->line_num); }
+#line 1657 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 190 "src/parser.y"
-    { (yyval.ast) = create_string_node((yyvsp[(1) - (1)].string_val), line_num); ;}
+  case 54: /* unary: MINUS unary  */
+#line 212 "src/parser.y"
+                                        { (yyval.ast) = create_unary_node(&ctx->ast, AST_OP_NEG, (yyvsp[0].ast), ctx->line_num); }
+#line 1663 "src/parser.tab.c"
     break;
 
-  case 54:
+  case 55: /* unary: primary  */
+#line 213 "src/parser.y"
+                                        { (yyval.ast) = (yyvsp[0].ast); }
+#line 1669 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 191 "src/parser.y"
-    { (yyval.ast) = create_identifier_node((yyvsp[(1) - (1)].string_val), line_num); ;}
+  case 56: /* primary: NUMBER  */
+#line 217 "src/parser.y"
+                                        { (yyval.ast) = create_number_node(&ctx->ast, (yyvsp[0].int_val), ctx->line_num); }
+#line 1675 "src/parser.tab.c"
     break;
 
-  case 55:
+  case 57: /* primary: STRING  */
+#line 218 "src/parser.y"
+                                        { (yyval.ast) = create_string_node(&ctx->ast, (yyvsp[0].string_val), ctx->line_num); }
+#line 1681 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 192 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(1) - (1)].ast); ;}
+  case 58: /* primary: IDENTIFIER  */
+#line 219 "src/parser.y"
+                                        { (yyval.ast) = create_identifier_node(&ctx->ast, (yyvsp[0].string_val), ctx->line_num); }
+#line 1687 "src/parser.tab.c"
     break;
 
-  case 56:
+  case 59: /* primary: function_call  */
+#line 220 "src/parser.y"
+                                        { (yyval.ast) = (yyvsp[0].ast); }
+#line 1693 "src/parser.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 193 "src/parser.y"
-    { (yyval.ast) = (yyvsp[(2) - (3)].ast); ;}
+  case 60: /* primary: LPAREN expression RPAREN  */
+#line 221 "src/parser.y"
+                                        { (yyval.ast) = (yyvsp[-1].ast); }
+#line 1699 "src/parser.tab.c"
     break;
 
 
+#line 1703 "src/parser.tab.c"
 
-/* Line 1455 of yacc.c  */
-#line 1892 "src/parser.tab.c"
       default: break;
     }
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (YY_("syntax error"));
-#else
-      {
-	YYSIZE_T yysize = yysyntax_error (0, yystate, yychar);
-	if (yymsg_alloc < yysize && yymsg_alloc < YYSTACK_ALLOC_MAXIMUM)
-	  {
-	    YYSIZE_T yyalloc = 2 * yysize;
-	    if (! (yysize <= yyalloc && yyalloc <= YYSTACK_ALLOC_MAXIMUM))
-	      yyalloc = YYSTACK_ALLOC_MAXIMUM;
-	    if (yymsg != yymsgbuf)
-	      YYSTACK_FREE (yymsg);
-	    yymsg = (char *) YYSTACK_ALLOC (yyalloc);
-	    if (yymsg)
-	      yymsg_alloc = yyalloc;
-	    else
-	      {
-		yymsg = yymsgbuf;
-		yymsg_alloc = sizeof yymsgbuf;
-	      }
-	  }
-
-	if (0 < yysize && yysize <= yymsg_alloc)
-	  {
-	    (void) yysyntax_error (yymsg, yystate, yychar);
-	    yyerror (yymsg);
-	  }
-	else
-	  {
-	    yyerror (YY_("syntax error"));
-	    if (yysize != 0)
-	      goto yyexhaustedlab;
-	  }
-      }
-#endif
+      yyerror (ctx, YY_("syntax error"));
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
-	 error, discard it.  */
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, ctx);
+          yychar = YYEMPTY;
+        }
     }
 
   /* Else will try to reuse lookahead token after shifting the error
@@ -1989,14 +1777,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -2009,39 +1796,42 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
-      if (yyn != YYPACT_NINF)
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, ctx);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
     }
 
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2052,59 +1842,106 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
-#if !defined(yyoverflow) || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (ctx, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
-     yydestruct ("Cleanup: discarding lookahead",
-		 yytoken, &yylval);
-  /* Do not reclaim the symbols of the rule which action triggered
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, ctx);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, ctx);
       YYPOPSTACK (1);
     }
-#ifndef yyoverflow
-  if (yyss != yyssa)
-    YYSTACK_FREE (yyss);
-#endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
+  yyps->yynew = 2;
+  goto yypushreturn;
 
 
+/*-------------------------.
+| yypushreturn -- return.  |
+`-------------------------*/
+yypushreturn:
 
-/* Line 1675 of yacc.c  */
-#line 196 "src/parser.y"
+  return yyresult;
+}
+#undef yynerrs
+#undef yystate
+#undef yyerrstatus
+#undef yyssa
+#undef yyss
+#undef yyssp
+#undef yyvsa
+#undef yyvs
+#undef yyvsp
+#undef yystacksize
+#line 224 "src/parser.y"
   // End grammar
 
-void yyerror(const char* msg) {
-    printf("Syntax Error at line %d: %s\n", line_num, msg);
-    has_syntax_error = 1;  // Set the syntax error flag
+// Append at the tail so the list stays in source order in O(1). Statements
+// dropped by error recovery (AST_NONE) are left out.
+static void append_statement(CompilerContext* ctx, StatementList* list, NodeId statement) {
+    if (!statement) return;
+    NodeId node = create_stmt_list_node(&ctx->ast, statement, AST_NONE, ctx->line_num);
+    if (list->tail) ast_node(&ctx->ast, list->tail)->stmt_list.next = node;
+    else list->head = node;
+    list->tail = node;
+}
+
+// A finished top-level statement joins the program's list or, when the context
+// streams, goes straight to ctx->on_statement. Its nodes are dropped once the
+// callback returns: at this point nothing left on the parser stack refers to
+// them, so the AST only ever holds the statement being parsed.
+//
+// ctx->root follows the list as it grows, so that the statements before a
+// syntax error the parser cannot recover from are still checked.
+static bool add_top_level_statement(CompilerContext* ctx, StatementList* list, NodeId statement) {
+    // Error recovery may have abandoned a function with its scope still open
+    ctx->ast.scope = 0;
+    if (!statement) return true;
+    if (ctx->on_statement) {
+        bool keep_going = ctx->on_statement(ctx, statement, ctx->on_statement_arg);
+        ast_clear(&ctx->ast);
+        return keep_going;
+    }
+    append_statement(ctx, list, statement);
+    ctx->root = list->head;
+    return true;
 }
 
+void yyerror(CompilerContext* ctx, const char* msg) {
+    char message[256];
+    snprintf(message, sizeof(message), "Syntax Error at line %d: %s", ctx->line_num, msg);
+    diagnostic_add(&ctx->diagnostics, ctx->line_num, message);
+    ctx->has_syntax_error = true;  // Set the syntax error flag
+}
@@ -2,25 +2,41 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "globals.h"
+#include "context.h"
 #include "ast.h"
 #include "semantic.h"
+#include "tokens.h"
 
-bool check_semantics(ASTNode* root, SymbolTable* table);
-
-extern int yylex();
-extern int yyparse();
-extern int line_num;
-extern ASTNode* root;  // Declare root as external
-extern ASTNode* ast_root;  // Declare ast_root as external
-void yyerror(const char* msg);
+// Tokens are pulled through next_token(), which replays a pre-lexed token
+// stream when one is set (see tokens.h) and otherwise calls the scanner.
+#define yylex next_token
+void yyerror(CompilerContext* ctx, const char* msg);
 %}
+%code requires {
+#include "ast.h"
+typedef struct CompilerContext CompilerContext;
+typedef struct { NodeId head; NodeId tail; } StatementList;  // list being built
+}
+%code {
+static void append_statement(CompilerContext* ctx, StatementList* list, NodeId statement);
+static bool add_top_level_statement(CompilerContext* ctx, StatementList* list, NodeId statement);
+}
+
+// Reentrant: all parser state lives in the CompilerContext passed to
+// yyparse() and on to the token source. The push interface (yypstate_new(),
+// yypush_parse()) lets the streaming driver feed tokens one at a time.
+%define api.pure full
+%define api.push-pull both
+%param { CompilerContext* ctx }
 %union {
     int int_val;
-    char* string_val;
-    struct ASTNode* ast;
+    const char* string_val;
+    NodeId ast;
+    StatementList list;
+    uint32_t scope;
 }
 
+// token_stream_stats() relies on each group below staying contiguous
 %token UNKNOWN
 %token <string_val> IDENTIFIER
 %token <int_val> NUMBER
@@ -33,41 +49,39 @@ void yyerror(const char* msg);
 
 %type <ast> program statement expression primary term factor unary logical_or logical_and equality comparison
 %type <ast> variable_declaration assignment if_statement for_loop function_declaration function_call input_statement publish_statement
-%type <ast> identifier_list argument_list statement_list for_init
+%type <ast> identifier_list argument_list for_init
+%type <list> top_level_list statement_list
+%type <scope> function_scope
 
 %%  
 
 program
-    : statement_list {
-        root = $1;
-        ast_root = $1;  // Set ast_root to the same value as root
-        $$ = $1;  // Return the root node
+    : top_level_list {
+        ctx->root = $1.head;
+        $$ = $1.head;  // Return the root node
+    }
+    ;
+
+// The program's own statements; see add_top_level_statement()
+top_level_list
+    : statement {
+        $$.head = $$.tail = AST_NONE;
+        if (!add_top_level_statement(ctx, &$$, $1)) YYABORT;
+    }
+    | top_level_list statement {
+        $$ = $1;
+        if (!add_top_level_statement(ctx, &$$, $2)) YYABORT;
     }
     ;
 
 statement_list
     : statement {
-        // If this is a variable declaration, add it to the front of the list
-        if ($1->type == AST_VAR_DECL) {
-            $$ = create_stmt_list_node($1, NULL, line_num);
-        } else {
-            // For other statements, add them to the end
-            $$ = create_stmt_list_node($1, NULL, line_num);
-        }
+        $$.head = $$.tail = AST_NONE;
+        append_statement(ctx, &$$, $1);
     }
     | statement_list statement {
-        if ($2->type == AST_VAR_DECL) {
-            // For variable declarations, add to the front
-            $$ = create_stmt_list_node($2, $1, line_num);
-        } else {
-            // For other statements, add to the end
-            ASTNode* current = $1;
-            while (current->stmt_list.next != NULL) {
-                current = current->stmt_list.next;
-            }
-            current->stmt_list.next = create_stmt_list_node($2, NULL, line_num);
-            $$ = $1;
-        }
+        $$ = $1;
+        append_statement(ctx, &$$, $2);
     }
     ;
 
@@ -80,21 +94,24 @@ statement
     | function_call SEMICOLON          { $$ = $1; }
     | input_statement SEMICOLON        { $$ = $1; }
     | publish_statement SEMICOLON      { $$ = $1; }
+    // Recovery: skip to the end of the broken statement and carry on, so one
+    // run reports every syntax error. The statement is dropped.
+    | error SEMICOLON                  { $$ = AST_NONE; yyerrok; }
     ;
 
 variable_declaration
-    : LET IDENTIFIER ASSIGN expression { $$ = create_var_decl_node($2, $4, line_num); }
+    : LET IDENTIFIER ASSIGN expression { $$ = create_var_decl_node(&ctx->ast, $2, $4, ctx->line_num); }
     ;
 
 assignment
-    : IDENTIFIER ASSIGN expression     { $$ = create_assignment_node($1, $3, line_num); }
+    : IDENTIFIER ASSIGN expression     { $$ = create_assignment_node(&ctx->ast, $1, $3, ctx->line_num); }
     ;
 
 if_statement
     : IF LPAREN expression RPAREN LBRACE statement_list RBRACE
-        { $$ = create_if_node($3, $6, NULL, line_num); }
+        { $$ = create_if_node(&ctx->ast, $3, $6.head, AST_NONE, ctx->line_num); }
     | IF LPAREN expression RPAREN LBRACE statement_list RBRACE ELSE LBRACE statement_list RBRACE
-        { $$ = create_if_node($3, $6, $10, line_num); }
+        { $$ = create_if_node(&ctx->ast, $3, $6.head, $10.head, ctx->line_num); }
     ;
 
 for_init
@@ -104,39 +121,50 @@ for_init
 
 for_loop
     : FOR LPAREN for_init SEMICOLON expression SEMICOLON assignment RPAREN LBRACE statement_list RBRACE
-        { $$ = create_for_node($3, $5, $7, $10, line_num); }
+        { $$ = create_for_node(&ctx->ast, $3, $5, $7, $10.head, ctx->line_num); }
     ;
 
 function_declaration
-    : FUNCTION IDENTIFIER LPAREN identifier_list RPAREN LBRACE statement_list RBRACE
-        { $$ = create_func_decl_node($2, $4, $7, line_num); }
-    | FUNCTION IDENTIFIER LPAREN RPAREN LBRACE statement_list RBRACE
-        { $$ = create_func_decl_node($2, NULL, $6, line_num); }
+    : FUNCTION IDENTIFIER LPAREN function_scope identifier_list RPAREN LBRACE statement_list RBRACE
+        {
+            ast_close_scope(&ctx->ast, $4);
+            $$ = create_func_decl_node(&ctx->ast, $2, $5, $8.head, ctx->line_num);
+        }
+    | FUNCTION IDENTIFIER LPAREN function_scope RPAREN LBRACE statement_list RBRACE
+        {
+            ast_close_scope(&ctx->ast, $4);
+            $$ = create_func_decl_node(&ctx->ast, $2, AST_NONE, $7.head, ctx->line_num);
+        }
+    ;
+
+// Identifiers in the parameters and body belong to the function's own scope
+function_scope
+    : %empty { $$ = ast_open_scope(&ctx->ast); }
     ;
 
 function_call
     : IDENTIFIER LPAREN argument_list RPAREN
-        { $$ = create_func_call_node($1, $3, line_num); }
+        { $$ = create_func_call_node(&ctx->ast, $1, $3, ctx->line_num); }
     | IDENTIFIER LPAREN RPAREN
-        { $$ = create_func_call_node($1, NULL, line_num); }
+        { $$ = create_func_call_node(&ctx->ast, $1, AST_NONE, ctx->line_num); }
     ;
 
 input_statement
-    : TAKE IDENTIFIER { $$ = create_input_node($2, line_num); }
+    : TAKE IDENTIFIER { $$ = create_input_node(&ctx->ast, $2, ctx->line_num); }
     ;
 
 publish_statement
-    : PUBLISH LPAREN expression RPAREN { $$ = create_publish_node($3, line_num); }
+    : PUBLISH LPAREN expression RPAREN { $$ = create_publish_node(&ctx->ast, $3, ctx->line_num); }
     ;
 
 identifier_list
-    : IDENTIFIER                         { $$ = create_identifier_list($1, NULL, line_num); }
-    | identifier_list COMMA IDENTIFIER  { $$ = create_identifier_list($3, $1, line_num); }
+    : IDENTIFIER                         { $$ = create_identifier_list(&ctx->ast, $1, AST_NONE, ctx->line_num); }
+    | identifier_list COMMA IDENTIFIER  { $$ = create_identifier_list(&ctx->ast, $3, $1, ctx->line_num); }
     ;
 
 argument_list
-    : expression                        { $$ = create_expr_list_node($1, NULL, line_num); }
-    | argument_list COMMA expression    { $$ = create_expr_list_node($3, $1, line_num); }
+    : expression                        { $$ = create_expr_list_node(&ctx->ast, $1, AST_NONE, ctx->line_num); }
+    | argument_list COMMA expression    { $$ = create_expr_list_node(&ctx->ast, $3, $1, ctx->line_num); }
     ;
 
 expression
@@ -145,57 +173,90 @@ expression
 
 logical_or
     : logical_and                       { $$ = $1; }
-    | logical_or OR logical_and         { $$ = create_binary_node("||", $1, $3, line_num); }
+    | logical_or OR logical_and         { $$ = create_binary_node(&ctx->ast, AST_OP_OR, $1, $3, ctx->line_num); }
     ;
 
 logical_and
     : equality                          { $$ = $1; }
-    | logical_and AND equality          { $$ = create_binary_node("&&", $1, $3, line_num); }
+    | logical_and AND equality          { $$ = create_binary_node(&ctx->ast, AST_OP_AND, $1, $3, ctx->line_num); }
     ;
 
 equality
     : comparison                        { $$ = $1; }
-    | equality EQ comparison            { $$ = create_binary_node("==", $1, $3, line_num); }
-    | equality NEQ comparison           { $$ = create_binary_node("!=", $1, $3, line_num); }
+    | equality EQ comparison            { $$ = create_binary_node(&ctx->ast, AST_OP_EQ, $1, $3, ctx->line_num); }
+    | equality NEQ comparison           { $$ = create_binary_node(&ctx->ast, AST_OP_NEQ, $1, $3, ctx->line_num); }
     ;
 
 comparison
     : term                              { $$ = $1; }
-    | comparison LT term                { $$ = create_binary_node("<", $1, $3, line_num); }
-    | comparison LEQ term               { $$ = create_binary_node("<=", $1, $3, line_num); }
-    | comparison GT term                { $$ = create_binary_node(">", $1, $3, line_num); }
-    | comparison GEQ term               { $$ = create_binary_node(">=", $1, $3, line_num); }
+    | comparison LT term                { $$ = create_binary_node(&ctx->ast, AST_OP_LT, $1, $3, ctx->line_num); }
+    | comparison LEQ term               { $$ = create_binary_node(&ctx->ast, AST_OP_LEQ, $1, $3, ctx->line_num); }
+    | comparison GT term                { $$ = create_binary_node(&ctx->ast, AST_OP_GT, $1, $3, ctx->line_num); }
+    | comparison GEQ term               { $$ = create_binary_node(&ctx->ast, AST_OP_GEQ, $1, $3, ctx->line_num); }
     ;
 
 term
     : factor                            { $$ = $1; }
-    | term PLUS factor                  { $$ = create_binary_node("+", $1, $3, line_num); }
-    | term MINUS factor                 { $$ = create_binary_node("-", $1, $3, line_num); }
+    | term PLUS factor                  { $$ = create_binary_node(&ctx->ast, AST_OP_ADD, $1, $3, ctx->line_num); }
+    | term MINUS factor                 { $$ = create_binary_node(&ctx->ast, AST_OP_SUB, $1, $3, ctx->line_num); }
     ;
 
 factor
     : unary                             { $$ = $1; }
-    | factor MUL unary                  { $$ = create_binary_node("*", $1, $3, line_num); }
-    | factor DIV unary                  { $$ = create_binary_node("/", $1, $3, line_num); }
+    | factor MUL unary                  { $$ = create_binary_node(&ctx->ast, AST_OP_MUL, $1, $3, ctx->line_num); }
+    | factor DIV unary                  { $$ = create_binary_node(&ctx->ast, AST_OP_DIV, $1, $3, ctx->line_num); }
     ;
 
 unary
-    : NOT unary                         { $$ = create_unary_node("!", $2, line_num); }
-    | MINUS unary                       { $$ = create_unary_node("-", $2, line_num); }
+    : NOT unary                         { $$ = create_unary_node(&ctx->ast, AST_OP_NOT, $2, ctx->line_num); }
+    | MINUS unary                       { $$ = create_unary_node(&ctx->ast, AST_OP_NEG, $2, ctx->line_num); }
     | primary                           { $$ = $1; }
     ;
 
 primary
-    : NUMBER                            { $$ = create_number_node($1, line_num); }
-    | STRING                            { $$ = create_string_node($1, line_num); }
-    | IDENTIFIER                        { $$ = create_identifier_node($1, line_num); }
+    : NUMBER                            { $$ = create_number_node(&ctx->ast, $1, ctx->line_num); }
+    | STRING                            { $$ = create_string_node(&ctx->ast, $1, ctx->line_num); }
+    | IDENTIFIER                        { $$ = create_identifier_node(&ctx->ast, $1, ctx->line_num); }
     | function_call                     { $$ = $1; }
     | LPAREN expression RPAREN          { $$ = $2; }
     ;
 
 %%  // End grammar
 
-void yyerror(const char* msg) {
-    printf("Syntax Error at line %d: %s\n", line_num, msg);
-    has_syntax_error = 1;  // Set the syntax error flag
+// Append at the tail so the list stays in source order in O(1). Statements
+// dropped by error recovery (AST_NONE) are left out.
+static void append_statement(CompilerContext* ctx, StatementList* list, NodeId statement) {
+    if (!statement) return;
+    NodeId node = create_stmt_list_node(&ctx->ast, statement, AST_NONE, ctx->line_num);
+    if (list->tail) ast_node(&ctx->ast, list->tail)->stmt_list.next = node;
+    else list->head = node;
+    list->tail = node;
+}
+
+// A finished top-level statement joins the program's list or, when the context
+// streams, goes straight to ctx->on_statement. Its nodes are dropped once the
+// callback returns: at this point nothing left on the parser stack refers to
+// them, so the AST only ever holds the statement being parsed.
+//
+// ctx->root follows the list as it grows, so that the statements before a
+// syntax error the parser cannot recover from are still checked.
+static bool add_top_level_statement(CompilerContext* ctx, StatementList* list, NodeId statement) {
+    // Error recovery may have abandoned a function with its scope still open
+    ctx->ast.scope = 0;
+    if (!statement) return true;
+    if (ctx->on_statement) {
+        bool keep_going = ctx->on_statement(ctx, statement, ctx->on_statement_arg);
+        ast_clear(&ctx->ast);
+        return keep_going;
+    }
+    append_statement(ctx, list, statement);
+    ctx->root = list->head;
+    return true;
+}
+
+void yyerror(CompilerContext* ctx, const char* msg) {
+    char message[256];
+    snprintf(message, sizeof(message), "Syntax Error at line %d: %s", ctx->line_num, msg);
+    diagnostic_add(&ctx->diagnostics, ctx->line_num, message);
+    ctx->has_syntax_error = true;  // Set the syntax error flag
 }
@@ -1,50 +1,111 @@
 #include "semantic.h"
+#include "context.h"
+#include "jobs.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Global error state
-SemanticError last_semantic_error = {false, 0, NULL};
+static void* grow_array(void* items, size_t count, size_t elem_size) {
+    void* grown = realloc(items, count * elem_size);
+    if (!grown) {
+        fprintf(stderr, "Error: out of memory in semantic analysis\n");
+        exit(1);
+    }
+    return grown;
+}
 
-static Symbol* create_symbol(const char* name, VarType type, int line_number) {
-    Symbol* sym = (Symbol*)malloc(sizeof(Symbol));
-    sym->name = strdup(name);
-    sym->type = type;
-    sym->line_number = line_number;
-    sym->next = NULL;
-    return sym;
+// Names are interned, so the slot of a name is found by hashing its pointer
+static size_t slot_hash(const char* name) {
+    return (size_t)(((uint64_t)(uintptr_t)name * 0x9E3779B97F4A7C15ull) >> 32);
 }
 
-static bool symbol_exists(Symbol* list, const char* name) {
-    while (list) {
-        if (strcmp(list->name, name) == 0) return true;
-        list = list->next;
+static const SymbolSlot* find_slot(const SymbolTable* table, const char* name) {
+    if (!table->slot_count) return NULL;
+    size_t mask = table->slot_count - 1;
+    for (size_t i = slot_hash(name) & mask; table->slots[i].name; i = (i + 1) & mask) {
+        if (table->slots[i].name == name) return &table->slots[i];
+    }
+    return NULL;
+}
+
+// The slot of name, claimed if the name has none yet. Slots are never freed:
+// a name whose declarations have all gone out of scope keeps an empty slot.
+static SymbolSlot* claim_slot(SymbolTable* table, const char* name) {
+    if ((table->slots_used + 1) * 2 > table->slot_count) {
+        size_t count = table->slot_count ? table->slot_count * 2 : 256;
+        SymbolSlot* slots = grow_array(NULL, count, sizeof(SymbolSlot));
+        memset(slots, 0, count * sizeof(SymbolSlot));
+        for (size_t j = 0; j < table->slot_count; j++) {
+            if (!table->slots[j].name) continue;
+            size_t i = slot_hash(table->slots[j].name) & (count - 1);
+            while (slots[i].name) i = (i + 1) & (count - 1);
+            slots[i] = table->slots[j];
+        }
+        free(table->slots);
+        table->slots = slots;
+        table->slot_count = count;
+    }
+    size_t mask = table->slot_count - 1;
+    size_t i = slot_hash(name) & mask;
+    while (table->slots[i].name && table->slots[i].name != name) i = (i + 1) & mask;
+    if (!table->slots[i].name) {
+        table->slots[i].name = name;
+        table->slots_used++;
     }
-    return false;
+    return &table->slots[i];
 }
 
-static void add_symbol(Symbol** list, const char* name, VarType type, int line_number) {
-    Symbol* sym = create_symbol(name, type, line_number);
-    sym->next = *list;
-    *list = sym;
+// The declaration of name in the innermost scope, if there is one. Outer
+// scopes are not visible from a function body.
+static Symbol* find_symbol(const SymbolTable* table, const char* name, bool function) {
+    const SymbolSlot* slot = find_slot(table, name);
+    uint32_t newest = slot ? (function ? slot->function : slot->variable) : 0;
+    if (!newest) return NULL;
+    Symbol* sym = &table->symbols[newest - 1];
+    return sym->scope == table->depth ? sym : NULL;
 }
 
-void clear_semantic_error(void) {
-    if (last_semantic_error.message) {
-        free(last_semantic_error.message);
+static bool symbol_exists(const SymbolTable* table, const char* name, bool function) {
+    return find_symbol(table, name, function) != NULL;
+}
+
+static void add_symbol(SymbolTable* table, const char* name, VarType type, int line_number,
+                       bool function) {
+    SymbolSlot* slot = claim_slot(table, name);
+    if (table->count == table->capacity) {
+        table->capacity = table->capacity ? table->capacity * 2 : 256;
+        table->symbols = grow_array(table->symbols, table->capacity, sizeof(Symbol));
     }
-    last_semantic_error.has_error = false;
-    last_semantic_error.line_number = 0;
-    last_semantic_error.message = NULL;
+    uint32_t* newest = function ? &slot->function : &slot->variable;
+    table->symbols[table->count] =
+        (Symbol){ name, type, line_number, *newest, (uint32_t)table->depth, function };
+    *newest = (uint32_t)++table->count;
 }
 
-SemanticError get_last_semantic_error(void) {
-    return last_semantic_error;
+void push_scope(SymbolTable* table) {
+    if (table->depth == table->scope_capacity) {
+        table->scope_capacity = table->scope_capacity ? table->scope_capacity * 2 : 16;
+        table->scope_start = grow_array(table->scope_start, table->scope_capacity, sizeof(size_t));
+    }
+    table->scope_start[table->depth++] = table->count;
 }
 
-void report_semantic_error(const char* message, const char* name, int line_number) {
-    clear_semantic_error();  // Clear any previous error
-    
+// The scope's declarations stay in the array, since nodes refer to them by
+// index; they only drop out of the index, which goes back to whatever they
+// hid. Declarations of inner scopes closed earlier are skipped.
+void pop_scope(SymbolTable* table) {
+    if (!table->depth) return;
+    size_t start = table->scope_start[--table->depth];
+    for (size_t i = table->count; i-- > start;) {
+        const Symbol* sym = &table->symbols[i];
+        if (sym->scope != table->depth + 1) continue;
+        SymbolSlot* slot = (SymbolSlot*)find_slot(table, sym->name);  // claimed on add
+        *(sym->function ? &slot->function : &slot->variable) = sym->shadowed;
+    }
+}
+
+void report_semantic_error(DiagnosticList* diagnostics, const char* message, const char* name,
+                           int line_number) {
     // Format the error message
     char* full_message;
     if (name) {
@@ -54,80 +115,40 @@ void report_semantic_error(const char* message, const char* name, int line_numbe
         full_message = malloc(strlen(message) + 50);
         sprintf(full_message, "Semantic Error at line %d: %s", line_number, message);
     }
-    
-    last_semantic_error.has_error = true;
-    last_semantic_error.line_number = line_number;
-    last_semantic_error.message = full_message;
+    diagnostic_add(diagnostics, line_number, full_message);
+    free(full_message);
 }
 
 SymbolTable* create_symbol_table(void) {
-    SymbolTable* table = (SymbolTable*)malloc(sizeof(SymbolTable));
+    SymbolTable* table = (SymbolTable*)calloc(1, sizeof(SymbolTable));
     if (!table) {
         fprintf(stderr, "Error: Failed to allocate symbol table\n");
         return NULL;
     }
-
-    // Initialize all fields to NULL
-    table->variables = NULL;
-    table->functions = NULL;
-
-    // Clear any previous semantic errors
-    clear_semantic_error();
-
     return table;
 }
 
 void free_symbol_table(SymbolTable* table) {
     if (!table) return;
-
-    // Free all variables
-    Symbol* cur = table->variables;
-    while (cur) {
-        Symbol* next = cur->next;
-        if (cur->name) {
-            free((char*)cur->name);
-        }
-        free(cur);
-        cur = next;
-    }
-
-    // Free all functions
-    cur = table->functions;
-    while (cur) {
-        Symbol* next = cur->next;
-        if (cur->name) {
-            free((char*)cur->name);
-        }
-        free(cur);
-        cur = next;
-    }
-
+    // Names are interned and not owned here
+    free(table->symbols);
+    free(table->slots);
+    free(table->scope_start);
     free(table);
 }
 
 void set_variable_type(SymbolTable* table, const char* name, VarType type) {
-    Symbol* sym = table->variables;
-    while (sym) {
-        if (strcmp(sym->name, name) == 0) {
-            sym->type = type;
-            return;
-        }
-        sym = sym->next;
-    }
+    Symbol* sym = find_symbol(table, name, false);
+    if (sym) sym->type = type;
 }
 
 VarType get_variable_type(SymbolTable* table, const char* name) {
-    Symbol* sym = table->variables;
-    while (sym) {
-        if (strcmp(sym->name, name) == 0) {
-            return sym->type;
-        }
-        sym = sym->next;
-    }
-    return TYPE_UNKNOWN;
+    Symbol* sym = find_symbol(table, name, false);
+    return sym ? sym->type : TYPE_UNKNOWN;
 }
 
-bool check_type_compatibility(VarType expected, VarType actual, const char* context, int line_number) {
+bool check_type_compatibility(DiagnosticList* diagnostics, VarType expected, VarType actual,
+                              const char* context, int line_number) {
     if (expected == TYPE_UNKNOWN || actual == TYPE_UNKNOWN) {
         return true;  // Allow unknown types during development
     }
@@ -137,157 +158,408 @@ bool check_type_compatibility(VarType expected, VarType actual, const char* cont
         snprintf(message, sizeof(message), 
                 "Type mismatch in %s: expected %s, got %s",
                 context, type_names[expected], type_names[actual]);
-        report_semantic_error(message, NULL, line_number);
+        report_semantic_error(diagnostics, message, NULL, line_number);
         return false;
     }
     return true;
 }
 
-VarType get_expression_type(ASTNode* node, SymbolTable* table) {
-    if (!node) return TYPE_UNKNOWN;
+VarType get_expression_type(const AST* ast, NodeId id) {
+    return id ? (VarType)ast_node(ast, id)->value_type : TYPE_UNKNOWN;
+}
 
-    switch (node->type) {
-        case AST_NUMBER:
-            return TYPE_INT;
-        case AST_STRING:
-            return TYPE_STRING;
-        case AST_IDENTIFIER:
-            return get_variable_type(table, node->identifier.name);
-        case AST_BINARY_OP:
-            // For arithmetic operations, result is integer
-            if (strcmp(node->binary.op, "+") == 0 ||
-                strcmp(node->binary.op, "-") == 0 ||
-                strcmp(node->binary.op, "*") == 0 ||
-                strcmp(node->binary.op, "/") == 0) {
-                return TYPE_INT;
-            }
-            // For comparison and logical operations, result is integer (0 or 1)
-            return TYPE_INT;
-        case AST_UNARY_OP:
-            return get_expression_type(node->unary.operand, table);
-        default:
-            return TYPE_UNKNOWN;
+// check_semantics() keeps its own stack of nodes still to be checked instead
+// of recursing, so long statement lists do not eat into the C stack. A node
+// whose check needs the types of its children is queued a second time, under
+// them, with `exit` set: by the time it comes off the stack again they have
+// all been checked and annotated. An end_scope item closes a function's scope
+// once its body has been checked; its node is the function that encloses it,
+// which calls are attributed to from then on.
+//
+// Numbers, identifiers and binary operations are shared by all their uses and
+// keep the line of the first (see ast.c), so each item also carries the line
+// of the innermost node around it that is not shared: that is where errors in
+// a shared node are reported.
+typedef struct {
+    NodeId node;
+    int line;
+    bool exit;
+    bool end_scope;
+} CheckItem;
+
+typedef struct {
+    CheckItem* items;
+    size_t count;
+    size_t capacity;
+} CheckStack;
+
+// Checking runs in two phases. The program's top level is walked first and
+// registers every top-level declaration, functions included, but leaves the
+// function bodies aside. A body only sees its own parameters and locals, so
+// the bodies are then independent of each other and of the top level, and are
+// checked as jobs on a thread pool, each against a table of its own. Their
+// declarations are appended to the program's table afterwards, in source
+// order, and the symbol links set inside each body are moved along with them.
+// Diagnostics from all the walks are merged by line.
+typedef struct {
+    NodeId decl;            // the top-level AST_FUNCTION_DECL
+    SymbolTable* table;
+    DiagnosticList diagnostics;
+    uint32_t** links;       // symbol fields set in the body, relative to table
+    size_t link_count;
+    size_t link_capacity;
+    CallGraph calls;
+} BodyCheck;
+
+typedef struct {
+    BodyCheck* items;
+    size_t count;
+    size_t capacity;
+} BodyChecks;
+
+// One walk: the top level, or one function body
+typedef struct {
+    AST* ast;
+    SymbolTable* table;
+    DiagnosticList* diagnostics;
+    CheckStack stack;
+    BodyChecks* bodies;     // top level: where function bodies are set aside
+    BodyCheck* body;        // body walk: the body being checked
+    CallGraph* calls;       // where resolved calls go; NULL: not recorded
+    NodeId function;        // function whose body is being checked, or AST_NONE
+} Checker;
+
+// Function bodies are checked on several threads only when the program is
+// at least this many nodes; below that, starting threads costs more than it
+// saves.
+#define MIN_PARALLEL_NODES (64 * 1024)
+
+static void push_item(CheckStack* stack, CheckItem item) {
+    if (stack->count == stack->capacity) {
+        stack->capacity = stack->capacity ? stack->capacity * 2 : 64;
+        stack->items = grow_array(stack->items, stack->capacity, sizeof(CheckItem));
+    }
+    stack->items[stack->count++] = item;
+}
+
+static void push_check(CheckStack* stack, NodeId node, int line) {
+    push_item(stack, (CheckItem){ node, line, false, false });
+}
+
+static void push_exit(CheckStack* stack, NodeId node) {
+    push_item(stack, (CheckItem){ node, 0, true, false });
+}
+
+static void push_end_scope(CheckStack* stack, NodeId outer_function) {
+    push_item(stack, (CheckItem){ outer_function, 0, false, true });
+}
+
+const Symbol* get_symbol(const SymbolTable* table, uint32_t ref) {
+    return ref ? &table->symbols[ref - 1] : NULL;
+}
+
+// Point a node's symbol field at sym, a declaration in the checker's table.
+// A shared identifier is linked again at each of its uses, always to the same
+// declaration, but a body must list its field only once: the field is moved
+// by the body's offset once for every time it is listed.
+static void link_symbol(Checker* c, uint32_t* field, const Symbol* sym) {
+    uint32_t ref = (uint32_t)(sym - c->table->symbols) + 1;
+    if (*field == ref) return;
+    *field = ref;
+    BodyCheck* body = c->body;
+    if (!body) return;
+    if (body->link_count == body->link_capacity) {
+        body->link_capacity = body->link_capacity ? body->link_capacity * 2 : 64;
+        body->links = grow_array(body->links, body->link_capacity, sizeof(uint32_t*));
+    }
+    body->links[body->link_count++] = field;
+}
+
+// Open a function's scope with its parameters and queue its body
+static void open_function(Checker* c, NodeId id) {
+    const ASTNode* decl = ast_node(c->ast, id);
+    push_scope(c->table);
+
+    // Register parameters with TYPE_UNKNOWN initially
+    NodeId param = decl->func_decl.params;
+    while (param) {
+        const ASTNode* p = ast_node(c->ast, param);
+        if (symbol_exists(c->table, p->id_list.id, false)) {
+            report_semantic_error(c->diagnostics, "Duplicate parameter", p->id_list.id, decl->line_number);
+        } else {
+            // Add parameter with TYPE_UNKNOWN as we don't know its type yet
+            add_symbol(c->table, p->id_list.id, TYPE_UNKNOWN, decl->line_number, false);
+        }
+        param = p->id_list.next;
     }
+
+    push_end_scope(&c->stack, c->function);
+    push_check(&c->stack, decl->func_decl.body, decl->line_number);
+    c->function = id;
 }
 
-bool check_semantics(ASTNode* node, SymbolTable* table) {
-    if (!node) return true;
+// Check one node and queue its children, last child first so that they are
+// checked in source order. An error is reported and checking goes on with
+// whatever can still be checked: an undeclared name is left unlinked, and
+// the value of a failed declaration or assignment is still checked. `line`
+// is the line of the item (see CheckItem).
+static void check_node(Checker* c, NodeId id, int line) {
+    if (!id) return;
+    SymbolTable* table = c->table;
+    DiagnosticList* diagnostics = c->diagnostics;
+    CheckStack* stack = &c->stack;
+    ASTNode* node = ast_node(c->ast, id);
+    if (!ast_is_shared((ASTNodeType)node->type)) line = node->line_number;
 
     switch (node->type) {
         case AST_VAR_DECL: {
-            // Get the type of the initializing expression
-            VarType expr_type = get_expression_type(node->var_decl.value, table);
-            
-            if (symbol_exists(table->variables, node->var_decl.name)) {
-                report_semantic_error("Variable redeclared", node->var_decl.name, node->line_number);
-                return false;
+            if (symbol_exists(table, node->var_decl.name, false)) {
+                report_semantic_error(diagnostics, "Variable redeclared", node->var_decl.name, node->line_number);
+            } else {
+                // Typed from its initializer on exit
+                add_symbol(table, node->var_decl.name, TYPE_UNKNOWN, node->line_number, false);
+                link_symbol(c, &node->var_decl.symbol, &table->symbols[table->count - 1]);
+                push_exit(stack, id);
             }
-            
-            // Add variable with its type
-            add_symbol(&table->variables, node->var_decl.name, expr_type, node->line_number);
-            return check_semantics(node->var_decl.value, table);
+            push_check(stack, node->var_decl.value, line);
+            return;
         }
 
         case AST_ASSIGNMENT: {
-            VarType var_type = get_variable_type(table, node->assignment.name);
-            VarType expr_type = get_expression_type(node->assignment.value, table);
-            
-            if (!symbol_exists(table->variables, node->assignment.name)) {
-                report_semantic_error("Assignment to undeclared variable", 
+            const Symbol* sym = find_symbol(table, node->assignment.name, false);
+            if (!sym) {
+                report_semantic_error(diagnostics, "Assignment to undeclared variable", 
                                     node->assignment.name, node->line_number);
-                return false;
-            }
-            
-            if (!check_type_compatibility(var_type, expr_type, "assignment", node->line_number)) {
-                return false;
+            } else {
+                link_symbol(c, &node->assignment.symbol, sym);
+                push_exit(stack, id);
             }
-            return check_semantics(node->assignment.value, table);
+            push_check(stack, node->assignment.value, line);
+            return;
         }
 
         case AST_INPUT: {
-            if (!symbol_exists(table->variables, node->input.name)) {
-                report_semantic_error("Input to undeclared variable", node->input.name, node->line_number);
-                return false;
+            const Symbol* sym = find_symbol(table, node->input.name, false);
+            if (!sym) {
+                report_semantic_error(diagnostics, "Input to undeclared variable", node->input.name, node->line_number);
+                return;
             }
+            link_symbol(c, &node->input.symbol, sym);
             // Note: Actual type checking of input will happen at runtime
-            return true;
+            return;
         }
 
         case AST_PUBLISH: {
             // Allow publishing of any type, but track the type for runtime
-            return check_semantics(node->publish.value, table);
+            push_check(stack, node->publish.value, line);
+            return;
         }
 
-        case AST_IDENTIFIER:
-            if (!symbol_exists(table->variables, node->identifier.name)) {
-                report_semantic_error("Use of undeclared variable", node->identifier.name, node->line_number);
-                return false;
+        case AST_IDENTIFIER: {
+            const Symbol* sym = find_symbol(table, node->identifier.name, false);
+            if (!sym) {
+                report_semantic_error(diagnostics, "Use of undeclared variable", node->identifier.name, line);
+                return;
             }
-            return true;
+            link_symbol(c, &node->identifier.symbol, sym);
+            node->value_type = (uint8_t)sym->type;
+            return;
+        }
+
+        case AST_BINARY_OP:
+            // Typed on creation (see ast_fixed_type()), like numbers and
+            // strings: such nodes may be shared between function bodies
+            // checked at the same time, so they are only read here.
+            push_check(stack, node->binary.right, line);
+            push_check(stack, node->binary.left, line);
+            return;
+
+        case AST_UNARY_OP:
+            // Takes the type of its operand on exit
+            push_exit(stack, id);
+            push_check(stack, node->unary.operand, line);
+            return;
 
         case AST_FUNCTION_DECL:
-            if (symbol_exists(table->functions, node->func_decl.name)) {
-                report_semantic_error("Function redeclared", node->func_decl.name, node->line_number);
-                return false;
+            if (symbol_exists(table, node->func_decl.name, true)) {
+                report_semantic_error(diagnostics, "Function redeclared", node->func_decl.name, node->line_number);
+            } else {
+                // Add function with TYPE_UNKNOWN as functions don't have a specific type
+                add_symbol(table, node->func_decl.name, TYPE_UNKNOWN, node->line_number, true);
+                table->symbols[table->count - 1].decl = id;
             }
-            // Add function with TYPE_UNKNOWN as functions don't have a specific type
-            add_symbol(&table->functions, node->func_decl.name, TYPE_UNKNOWN, node->line_number);
-
-            {
-                SymbolTable* localTable = create_symbol_table();
-
-                // Register parameters with TYPE_UNKNOWN initially
-                ASTNode* param = node->func_decl.params;
-                while (param) {
-                    if (symbol_exists(localTable->variables, param->id_list.id)) {
-                        report_semantic_error("Duplicate parameter", param->id_list.id, node->line_number);
-                        free_symbol_table(localTable);
-                        return false;
-                    }
-                    // Add parameter with TYPE_UNKNOWN as we don't know its type yet
-                    add_symbol(&localTable->variables, param->id_list.id, TYPE_UNKNOWN, node->line_number);
-                    param = param->id_list.next;
-                }
 
-                bool result = check_semantics(node->func_decl.body, localTable);
-                free_symbol_table(localTable);
-                return result;
+            if (c->bodies) {
+                BodyChecks* bodies = c->bodies;
+                if (bodies->count == bodies->capacity) {
+                    bodies->capacity = bodies->capacity ? bodies->capacity * 2 : 16;
+                    bodies->items = grow_array(bodies->items, bodies->capacity, sizeof(BodyCheck));
+                }
+                bodies->items[bodies->count++] = (BodyCheck){ .decl = id };
+            } else {
+                open_function(c, id);
             }
+            return;
 
-        case AST_FUNCTION_CALL:
-            if (!symbol_exists(table->functions, node->func_call.name)) {
-                report_semantic_error("Call to undeclared function", node->func_call.name, node->line_number);
-                return false;
+        case AST_FUNCTION_CALL: {
+            const Symbol* sym = find_symbol(table, node->func_call.name, true);
+            if (!sym) {
+                report_semantic_error(diagnostics, "Call to undeclared function", node->func_call.name, node->line_number);
+            } else {
+                link_symbol(c, &node->func_call.symbol, sym);
+                if (c->calls) call_graph_add(c->calls, c->function, sym->decl);
             }
-            return check_semantics(node->func_call.args, table);
+            push_check(stack, node->func_call.args, line);
+            return;
+        }
 
         case AST_IF:
-            return check_semantics(node->if_stmt.condition, table) &&
-                   check_semantics(node->if_stmt.then_branch, table) &&
-                   (!node->if_stmt.else_branch || check_semantics(node->if_stmt.else_branch, table));
+            push_check(stack, node->if_stmt.else_branch, line);
+            push_check(stack, node->if_stmt.then_branch, line);
+            push_check(stack, node->if_stmt.condition, line);
+            return;
 
         case AST_FOR:
-            return check_semantics(node->for_loop.init, table) &&
-                   check_semantics(node->for_loop.cond, table) &&
-                   check_semantics(node->for_loop.post, table) &&
-                   check_semantics(node->for_loop.body, table);
+            push_check(stack, node->for_loop.body, line);
+            push_check(stack, node->for_loop.post, line);
+            push_check(stack, node->for_loop.cond, line);
+            push_check(stack, node->for_loop.init, line);
+            return;
 
         case AST_STATEMENT_LIST:
-            return check_semantics(node->stmt_list.stmt, table) &&
-                   check_semantics(node->stmt_list.next, table);
+            push_check(stack, node->stmt_list.next, line);
+            push_check(stack, node->stmt_list.stmt, line);
+            return;
 
         case AST_EXPR_LIST:
-            return check_semantics(node->expr_list.expr, table) &&
-                   check_semantics(node->expr_list.next, table);
+            push_check(stack, node->expr_list.next, line);
+            push_check(stack, node->expr_list.expr, line);
+            return;
+
+        default:
+            return;
+    }
+}
+
+// Finish a node once its children are checked
+static void check_exit(Checker* c, NodeId id) {
+    const AST* ast = c->ast;
+    ASTNode* node = ast_node(ast, id);
+
+    switch (node->type) {
+        case AST_VAR_DECL:
+            c->table->symbols[node->var_decl.symbol - 1].type =
+                get_expression_type(ast, node->var_decl.value);
+            return;
+
+        case AST_ASSIGNMENT:
+            check_type_compatibility(c->diagnostics,
+                                     get_symbol(c->table, node->assignment.symbol)->type,
+                                     get_expression_type(ast, node->assignment.value),
+                                     "assignment", node->line_number);
+            return;
+
+        case AST_UNARY_OP:
+            node->value_type = (uint8_t)get_expression_type(ast, node->unary.operand);
+            return;
 
         default:
-            return true;
+            return;
+    }
+}
+
+static void run_checker(Checker* c) {
+    while (c->stack.count) {
+        CheckItem item = c->stack.items[--c->stack.count];
+        if (item.end_scope) {
+            pop_scope(c->table);
+            c->function = item.node;
+        } else if (item.exit) {
+            check_exit(c, item.node);
+        } else {
+            check_node(c, item.node, item.line);
+        }
+    }
+    free(c->stack.items);
+    c->stack = (CheckStack){ NULL, 0, 0 };
+}
+
+typedef struct {
+    AST* ast;
+    BodyChecks* bodies;
+    size_t diagnostic_limit;
+    bool record_calls;
+} BodyJobs;
+
+static void check_body_job(void* arg, size_t index) {
+    BodyJobs* jobs = arg;
+    BodyCheck* body = &jobs->bodies->items[index];
+    body->table = create_symbol_table();
+    if (!body->table) exit(1);
+    diagnostics_init(&body->diagnostics, jobs->diagnostic_limit);
+
+    Checker c = { jobs->ast, body->table, &body->diagnostics, { NULL, 0, 0 }, NULL, body,
+                  jobs->record_calls ? &body->calls : NULL, AST_NONE };
+    open_function(&c, body->decl);
+    run_checker(&c);
+}
+
+// Move a checked body's declarations to the end of the program's table
+static void append_body_symbols(SymbolTable* table, BodyCheck* body) {
+    const SymbolTable* from = body->table;
+    uint32_t offset = (uint32_t)table->count;
+    if (table->count + from->count > table->capacity) {
+        table->capacity = table->count + from->count;
+        table->symbols = grow_array(table->symbols, table->capacity, sizeof(Symbol));
     }
+    for (size_t i = 0; i < from->count; i++) {
+        Symbol sym = from->symbols[i];
+        if (sym.shadowed) sym.shadowed += offset;
+        table->symbols[table->count++] = sym;
+    }
+    for (size_t i = 0; i < body->link_count; i++) *body->links[i] += offset;
+}
+
+// Check the bodies set aside by the top-level walk and take over their
+// declarations, diagnostics and calls, in source order
+static void check_function_bodies(CompilerContext* ctx, BodyChecks* bodies, CallGraph* calls) {
+    int threads = ctx->check_threads > 0 ? ctx->check_threads : online_cpus();
+    if (ctx->ast.count < MIN_PARALLEL_NODES) threads = 1;
+    BodyJobs jobs = { &ctx->ast, bodies, ctx->diagnostics.limit, calls != NULL };
+    run_jobs(threads, bodies->count, check_body_job, &jobs);
+
+    for (size_t i = 0; i < bodies->count; i++) {
+        BodyCheck* body = &bodies->items[i];
+        append_body_symbols(ctx->table, body);
+        diagnostics_append(&ctx->diagnostics, &body->diagnostics);
+        diagnostics_release(&body->diagnostics);
+        if (calls) call_graph_append(calls, &body->calls);
+        call_graph_release(&body->calls);
+        free_symbol_table(body->table);
+        free(body->links);
+    }
+}
+
+bool check_semantics(CompilerContext* ctx, NodeId root) {
+    size_t first = ctx->diagnostics.count;
+    size_t total = diagnostics_total(&ctx->diagnostics);
+    // A streamed program is compiled statement by statement as it is parsed,
+    // so it has no use for a call graph, which would only grow with its length
+    CallGraph* calls = ctx->on_statement ? NULL : &ctx->calls;
+    BodyChecks bodies = { NULL, 0, 0 };
+    Checker top = { &ctx->ast, ctx->table, &ctx->diagnostics, { NULL, 0, 0 }, &bodies, NULL,
+                    calls, AST_NONE };
+    push_check(&top.stack, root, 0);
+    run_checker(&top);
+    if (bodies.count) check_function_bodies(ctx, &bodies, calls);
+    free(bodies.items);
+
+    diagnostics_sort(&ctx->diagnostics, first);
+    return diagnostics_total(&ctx->diagnostics) == total;
 }
 
-// Alias for check_semantics
-bool analyze_ast(ASTNode* root, SymbolTable* table) {
-    return check_semantics(root, table);
+bool analyze_ast(CompilerContext* ctx, NodeId root) {
+    return check_semantics(ctx, root);
 }
 
 // Print symbol table contents
@@ -296,22 +568,22 @@ void print_symbol_table(SymbolTable* table) {
 
     printf("\n=== Symbol Table ===\n");
     
-    // Print variables
+    // Print the innermost scope, newest declarations first
     printf("Variables:\n");
-    Symbol* var = table->variables;
-    while (var) {
+    for (size_t i = table->count; i-- > 0;) {
+        const Symbol* var = &table->symbols[i];
+        if (var->function || var->scope != table->depth) continue;
         const char* type_str = var->type == TYPE_INT ? "int" :
                               var->type == TYPE_STRING ? "string" : "unknown";
         printf("  %s (%s) at line %d\n", var->name, type_str, var->line_number);
-        var = var->next;
     }
     
     // Print functions
     printf("\nFunctions:\n");
-    Symbol* func = table->functions;
-    while (func) {
+    for (size_t i = table->count; i-- > 0;) {
+        const Symbol* func = &table->symbols[i];
+        if (!func->function || func->scope != table->depth) continue;
         printf("  %s at line %d\n", func->name, func->line_number);
-        func = func->next;
     }
     
     printf("=== End Symbol Table ===\n\n");
@@ -0,0 +1,117 @@
+#include "source.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool source_read_stream(SourceBuffer* src, FILE* in) {
+    memset(src, 0, sizeof(*src));
+    size_t capacity = 64 * 1024;
+    char* data = malloc(capacity);
+    size_t size = 0;
+    while (data) {
+        if (capacity - size <= 2) {  // keep room for the sentinels
+            capacity *= 2;
+            char* grown = realloc(data, capacity);
+            if (!grown) break;
+            data = grown;
+        }
+        size_t n = fread(data + size, 1, capacity - size - 2, in);
+        size += n;
+        if (n == 0) {
+            if (ferror(in)) break;
+            data[size] = '\0';
+            data[size + 1] = '\0';
+            src->data = data;
+            src->size = size;
+            return true;
+        }
+    }
+    free(data);
+    return false;
+}
+
+void source_release(SourceBuffer* src) {
+    if (src->mapping) {
+#ifndef _WIN32
+        munmap(src->mapping, src->mapping_size);
+#endif
+    } else {
+        free(src->data);
+    }
+    memset(src, 0, sizeof(*src));
+}
+
+#ifdef _WIN32
+
+// No mmap here: read the file in one go into a padded heap buffer instead.
+bool source_map_file(SourceBuffer* src, const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    bool ok = source_read_stream(src, f);
+    fclose(f);
+    return ok;
+}
+
+#else
+
+bool source_map_file(SourceBuffer* src, const char* path) {
+    memset(src, 0, sizeof(*src));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+
+    // Reserve zero-filled pages covering the file plus the two sentinels, then
+    // map the file over the front of the reservation. The tail of the file's
+    // last page and any page after it read as zero, which gives flex its
+    // end-of-buffer markers without copying the file.
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = (size_t)st.st_size;
+    size_t mapping_size = (size + 2 + page - 1) / page * page;
+
+    char* base = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    if (size > 0) {
+        // Private and writable: the scanner pokes NULs into the buffer while
+        // matching, and those writes must never reach the file.
+        int flags = MAP_PRIVATE | MAP_FIXED;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;  // the whole file is about to be scanned anyway
+#endif
+        void* file = mmap(base, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if (file == MAP_FAILED) {
+            int saved = errno;
+            munmap(base, mapping_size);
+            close(fd);
+            errno = saved;
+            return false;
+        }
+    }
+    close(fd);
+
+    src->data = base;
+    src->size = size;
+    src->mapping = base;
+    src->mapping_size = mapping_size;
+    return true;
+}
+
+#endif
@@ -1,21 +1,17 @@
 #include "token_display.h"
 #include "parser.tab.h"  // Include this to get token definitions
+#include "tokens.h"
 #include <stdio.h>
 #include <string.h>
 
-// Structure to track token categories
-typedef struct {
-    int count;
-    const char* name;
-} TokenCategory;
-
-static TokenCategory categories[] = {
-    {0, "Keywords"},
-    {0, "Operators"},
-    {0, "Punctuations"},
-    {0, "Identifiers"},
-    {0, "Literals"},
-    {0, NULL}  // Terminator
+// Display names of the token categories
+static const char* const categories[] = {
+    "Keywords",
+    "Operators",
+    "Punctuations",
+    "Identifiers",
+    "Literals",
+    NULL  // Terminator
 };
 
 // Map token values to their descriptive names and categories
@@ -68,49 +64,56 @@ static const char* get_token_name(int token, int* category) {
     }
 }
 
-void init_token_display(void) {
-    printf("\n=== Lexical Analysis ===\n");
+void init_token_display(TokenDisplay* display) {
+    fprintf(display->out, "\n=== Lexical Analysis ===\n");
     // Reset category counts
-    for (int i = 0; categories[i].name != NULL; i++) {
-        categories[i].count = 0;
+    for (int i = 0; categories[i] != NULL; i++) {
+        display->counts[i] = 0;
     }
 }
 
-void display_token(int token, const char* text, int line) {
+void display_token(TokenDisplay* display, int token, const char* text, int length, int line) {
     (void)line;  // Explicitly mark parameter as unused if we don't need it
     int category;
     const char* token_name = get_token_name(token, &category);
     
     if (category >= 0 && category < 5) {
-        categories[category].count++;
+        display->counts[category]++;
         
         // Only print the first occurrence of each category
-        if (categories[category].count == 1) {
-            printf("\n%s:\n", categories[category].name);
+        if (display->counts[category] == 1) {
+            fprintf(display->out, "\n%s:\n", categories[category]);
         }
         
         // Print token with appropriate formatting
         switch (token) {
             case IDENTIFIER:
-                printf("  %s: %s\n", token_name, text);
+                fprintf(display->out, "  %s: %.*s\n", token_name, length, text);
                 break;
             case NUMBER:
-                printf("  %s: %s\n", token_name, text);
+                fprintf(display->out, "  %s: %.*s\n", token_name, length, text);
                 break;
             case STRING:
-                printf("  %s: %s\n", token_name, text);
+                fprintf(display->out, "  %s: %.*s\n", token_name, length, text);
                 break;
             default:
-                printf("  %s\n", token_name);
+                fprintf(display->out, "  %s\n", token_name);
                 break;
         }
     }
 }
 
-void finalize_token_display(void) {
-    printf("\nToken Statistics:\n");
-    for (int i = 0; categories[i].name != NULL; i++) {
-        printf("%s: %d tokens\n", categories[i].name, categories[i].count);
+void print_token_statistics(FILE* out, const size_t counts[]) {
+    fprintf(out, "\nToken Statistics:\n");
+    for (int i = 0; categories[i] != NULL; i++) {
+        fprintf(out, "%s: %zu tokens\n", categories[i], counts[i]);
+    }
+}
+
+void finalize_token_display(TokenDisplay* display) {
+    size_t counts[TOKEN_CAT_COUNT];
+    for (int i = 0; i < TOKEN_CAT_COUNT; i++) {
+        counts[i] = (size_t)display->counts[i];
     }
-    printf("\n=== End of Lexical Analysis ===\n\n");
+    print_token_statistics(display->out, counts);
 } 
\ No newline at end of file
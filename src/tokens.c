@@ -0,0 +1,130 @@
+#include "tokens.h"
+#include "context.h"
+#include "parser.tab.h"
+#include "scanner.h"
+#include "token_display.h"
+#include "intern.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void* grow_array(void* array, size_t count, size_t elem_size) {
+    void* grown = realloc(array, count * elem_size);
+    if (!grown) {
+        fprintf(stderr, "Error: out of memory for token stream\n");
+        exit(1);
+    }
+    return grown;
+}
+
+void token_stream_init(TokenStream* ts) {
+    memset(ts, 0, sizeof(*ts));
+}
+
+void token_stream_free(TokenStream* ts) {
+    free(ts->kind);
+    free(ts->offset);
+    free(ts->length);
+    free(ts->line);
+    free(ts->value);
+    memset(ts, 0, sizeof(*ts));
+}
+
+void token_stream_reserve(TokenStream* ts, size_t capacity) {
+    if (capacity <= ts->capacity) return;
+    ts->kind = grow_array(ts->kind, capacity, sizeof(*ts->kind));
+    ts->offset = grow_array(ts->offset, capacity, sizeof(*ts->offset));
+    ts->length = grow_array(ts->length, capacity, sizeof(*ts->length));
+    ts->line = grow_array(ts->line, capacity, sizeof(*ts->line));
+    ts->value = grow_array(ts->value, capacity, sizeof(*ts->value));
+    ts->capacity = capacity;
+}
+
+void token_stream_push(TokenStream* ts, int token, uint32_t offset, uint32_t length,
+                       uint32_t line, int32_t value) {
+    if (ts->count == ts->capacity) {
+        token_stream_reserve(ts, ts->capacity ? ts->capacity * 2 : 4096);
+    }
+    size_t i = ts->count++;
+    ts->kind[i] = (uint8_t)(token ? token - TOKEN_KIND_BASE : 0);
+    ts->offset[i] = offset;
+    ts->length[i] = length;
+    ts->line[i] = line;
+    ts->value[i] = value;
+}
+
+void token_stream_replay(CompilerContext* ctx, const TokenStream* ts) {
+    ctx->replay = ts;
+    ctx->replay_pos = 0;
+}
+
+int next_token(YYSTYPE* lval, CompilerContext* ctx) {
+    const TokenStream* replay = ctx->replay;
+    if (!replay) {
+        int token = yylex(lval, ctx->scanner);
+        ctx->line_num = ctx->scan.line;
+        return token;
+    }
+
+    // The stream always ends with the end-of-input token; keep returning it.
+    size_t i = ctx->replay_pos;
+    if (i + 1 < replay->count) ctx->replay_pos++;
+
+    int token = replay->kind[i] ? replay->kind[i] + TOKEN_KIND_BASE : 0;
+    ctx->line_num = (int)replay->line[i];
+    switch (token) {
+        case IDENTIFIER:
+        case STRING:
+            lval->string_val = intern_name(&ctx->names, (InternId)replay->value[i]);
+            break;
+        case NUMBER:
+            lval->int_val = replay->value[i];
+            break;
+        default:
+            break;
+    }
+    return token;
+}
+
+void token_stream_stats(const TokenStream* ts, size_t counts[TOKEN_CAT_COUNT]) {
+    // The token groups are declared contiguously in parser.y, so each
+    // category is a range test. Written branch-free over the kind bytes so
+    // the compiler can vectorise the loop.
+    const uint8_t keyword = LET - TOKEN_KIND_BASE;
+    const uint8_t keyword_span = PUBLISH - LET;
+    const uint8_t op = EQ - TOKEN_KIND_BASE;
+    const uint8_t op_span = NOT - EQ;
+    const uint8_t punct = LPAREN - TOKEN_KIND_BASE;
+    const uint8_t punct_span = SEMICOLON - LPAREN;
+    const uint8_t ident = IDENTIFIER - TOKEN_KIND_BASE;
+    const uint8_t literal = NUMBER - TOKEN_KIND_BASE;
+    const uint8_t literal_span = STRING - NUMBER;
+
+    size_t keywords = 0, operators = 0, punctuation = 0, identifiers = 0, literals = 0;
+    const uint8_t* kind = ts->kind;
+    for (size_t i = 0; i < ts->count; i++) {
+        uint8_t k = kind[i];
+        keywords += (uint8_t)(k - keyword) <= keyword_span;
+        operators += (uint8_t)(k - op) <= op_span;
+        punctuation += (uint8_t)(k - punct) <= punct_span;
+        identifiers += k == ident;
+        literals += (uint8_t)(k - literal) <= literal_span;
+    }
+
+    counts[TOKEN_CAT_KEYWORD] = keywords;
+    counts[TOKEN_CAT_OPERATOR] = operators;
+    counts[TOKEN_CAT_PUNCTUATION] = punctuation;
+    counts[TOKEN_CAT_IDENTIFIER] = identifiers;
+    counts[TOKEN_CAT_LITERAL] = literals;
+}
+
+void display_token_stream(FILE* out, const TokenStream* ts, const char* source) {
+    TokenDisplay display = { out, {0} };
+    for (size_t i = 0; i < ts->count && ts->kind[i]; i++) {
+        display_token(&display, ts->kind[i] + TOKEN_KIND_BASE, source + ts->offset[i],
+                      (int)ts->length[i], (int)ts->line[i]);
+    }
+
+    size_t counts[TOKEN_CAT_COUNT];
+    token_stream_stats(ts, counts);
+    print_token_statistics(out, counts);
+}